@@ -0,0 +1,101 @@
+/**
+Time to add increments to a TimeSeries from a number of threads:
+ConcurrentTimeSeries compared to a TimeSeries guarded by a single mutex.
+Each increment is composed by the thread that adds it.
+
+Usage: concurrent_timeseries [number of increments] [number of fields] [maximum number of threads]
+
+The number of threads is doubled up to the maximum (default: the number of hardware threads).
+Note that scaling can only be observed up to the number of cores.
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <XDMFWrite_HighFive.hpp>
+
+namespace xh = XDMFWrite_HighFive;
+
+std::vector<xh::Element> fields(size_t inc, size_t nfields)
+{
+    std::vector<xh::Element> ret;
+    ret.reserve(nfields);
+
+    for (size_t i = 0; i < nfields; ++i) {
+        std::string name = "field" + std::to_string(i);
+        std::string path = "/" + name + "/" + std::to_string(inc);
+        ret.push_back(xh::Attribute(
+            "/path/to/simulation/output.h5", path, std::vector<size_t>{100000, 3},
+            xh::AttributeCenter::Node, name));
+    }
+
+    return ret;
+}
+
+template <class F>
+double run(size_t nthreads, size_t ninc, F add)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < nthreads; ++t) {
+        threads.emplace_back([=]() {
+            for (size_t inc = t; inc < ninc; inc += nthreads) {
+                add(inc);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(stop - start).count();
+}
+
+int main(int argc, char* argv[])
+{
+    size_t ninc = argc > 1 ? std::stoul(argv[1]) : 20000;
+    size_t nfields = argc > 2 ? std::stoul(argv[2]) : 20;
+    size_t ncores = argc > 3 ? std::stoul(argv[3]) : std::max(std::thread::hardware_concurrency(), 1u);
+
+    std::cout << ninc << " increments of " << nfields << " fields" << std::endl;
+    std::cout << "threads  TimeSeries+mutex [s]  ConcurrentTimeSeries [s]" << std::endl;
+
+    // the mutex-guarded TimeSeries is in order of arrival, ConcurrentTimeSeries is sorted by time
+    xh::TimeSeries expected;
+    for (size_t inc = 0; inc < ninc; ++inc) {
+        expected.push_back(0.1 * inc, fields(inc, nfields));
+    }
+
+    for (size_t nthreads = 1; nthreads <= ncores; nthreads *= 2) {
+
+        xh::TimeSeries series;
+        std::mutex mutex;
+
+        double locked = run(nthreads, ninc, [&](size_t inc) {
+            auto args = fields(inc, nfields);
+            std::lock_guard<std::mutex> lock(mutex);
+            series.push_back(0.1 * inc, std::move(args));
+        });
+
+        xh::ConcurrentTimeSeries concurrent;
+
+        double sharded = run(nthreads, ninc, [&](size_t inc) {
+            concurrent.push_back(0.1 * inc, fields(inc, nfields));
+        });
+
+        if (concurrent.get() != expected.get()) {
+            std::cerr << "Output differs" << std::endl;
+            return 1;
+        }
+
+        std::cout << std::setw(7) << nthreads << "  "
+                  << std::setw(22) << locked << "  "
+                  << std::setw(24) << sharded << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,139 @@
+/**
+Memory used by a TimeSeries, compared to storing each increment as rendered lines
+(the representation used before TimeSeries stored its increments compactly),
+or as Element-s.
+
+Usage: timeseries_memory [number of increments] [number of fields]
+*/
+
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <XDMFWrite_HighFive.hpp>
+
+namespace xh = XDMFWrite_HighFive;
+
+// Track the number of bytes currently allocated.
+// The size of each allocation is stored in front of it, such that it is known on deallocation,
+// whether or not sized deallocation is used (e.g. Clang < 19 does not by default).
+
+static size_t allocated = 0;
+static const size_t prefix = alignof(std::max_align_t);
+
+void* operator new(size_t n)
+{
+    char* ptr = static_cast<char*>(std::malloc(n + prefix));
+    if (!ptr) {
+        throw std::bad_alloc();
+    }
+    *reinterpret_cast<size_t*>(ptr) = n;
+    allocated += n;
+    return ptr + prefix;
+}
+
+void* operator new(size_t n, const std::nothrow_t&) noexcept
+{
+    try {
+        return operator new(n);
+    }
+    catch (...) {
+        return nullptr;
+    }
+}
+
+void operator delete(void* ptr) noexcept
+{
+    if (!ptr) {
+        return;
+    }
+    char* base = static_cast<char*>(ptr) - prefix;
+    allocated -= *reinterpret_cast<size_t*>(base);
+    std::free(base);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+    operator delete(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept
+{
+    operator delete(ptr);
+}
+
+std::vector<xh::Element> fields(size_t inc, size_t nfields)
+{
+    std::vector<xh::Element> ret;
+    ret.reserve(nfields);
+
+    for (size_t i = 0; i < nfields; ++i) {
+        std::string name = "field" + std::to_string(i);
+        std::string path = "/" + name + "/" + std::to_string(inc);
+        ret.push_back(xh::Attribute(
+            "/path/to/simulation/output.h5", path, std::vector<size_t>{100000, 3},
+            xh::AttributeCenter::Node, name));
+    }
+
+    return ret;
+}
+
+int main(int argc, char* argv[])
+{
+    size_t ninc = argc > 1 ? std::stoul(argv[1]) : 10000;
+    size_t nfields = argc > 2 ? std::stoul(argv[2]) : 20;
+
+    size_t before;
+    size_t lines;
+    size_t elements;
+    size_t series;
+
+    {
+        before = allocated;
+        std::vector<std::vector<std::string>> data;
+        for (size_t inc = 0; inc < ninc; ++inc) {
+            data.push_back(xh::detail::increment(
+                "Increment " + std::to_string(inc), xh::detail::to<double>::str(0.1 * inc),
+                xh::Element(), fields(inc, nfields)).get());
+        }
+        lines = allocated - before;
+    }
+
+    {
+        before = allocated;
+        std::vector<xh::Element> data;
+        for (size_t inc = 0; inc < ninc; ++inc) {
+            data.push_back(xh::detail::increment(
+                "Increment " + std::to_string(inc), xh::detail::to<double>::str(0.1 * inc),
+                xh::Element(), fields(inc, nfields)));
+        }
+        elements = allocated - before;
+    }
+
+    double render;
+
+    {
+        before = allocated;
+        xh::TimeSeries data;
+        for (size_t inc = 0; inc < ninc; ++inc) {
+            data.push_back(0.1 * inc, fields(inc, nfields));
+        }
+        series = allocated - before;
+
+        auto start = std::chrono::steady_clock::now();
+        std::string xdmf = xh::write(data);
+        auto stop = std::chrono::steady_clock::now();
+        render = std::chrono::duration<double>(stop - start).count();
+    }
+
+    std::cout << ninc << " increments of " << nfields << " fields" << std::endl;
+    std::cout << "lines       : " << lines / 1e6 << " MB" << std::endl;
+    std::cout << "Element-s   : " << elements / 1e6 << " MB" << std::endl;
+    std::cout << "TimeSeries  : " << series / 1e6 << " MB" << std::endl;
+    std::cout << "reduction   : " << static_cast<double>(lines) / series << "x (lines), "
+              << static_cast<double>(elements) / series << "x (Element-s)" << std::endl;
+    std::cout << "write()     : " << render << " s" << std::endl;
+
+    return 0;
+}
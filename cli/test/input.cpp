@@ -0,0 +1,25 @@
+/**
+Write HDF5-files with a mesh and a field per increment, as input for the smoke test of
+xdmfwrite-batch.
+
+Usage: xdmfwrite-batch-input FILE...
+*/
+
+#include <string>
+#include <vector>
+#include <highfive/H5Easy.hpp>
+
+int main(int argc, char* argv[])
+{
+    for (int i = 1; i < argc; ++i) {
+        H5Easy::File file(argv[i], H5Easy::File::Overwrite);
+        H5Easy::dump(file, "/coor", std::vector<double>{0, 0, 1, 0, 1, 1, 0, 1}, {4, 2});
+        H5Easy::dump(file, "/conn", std::vector<size_t>{0, 1, 2, 3}, {1, 4});
+        H5Easy::dump(file, "/time", std::vector<double>{0.0, 0.5});
+        for (size_t inc = 0; inc < 2; ++inc) {
+            H5Easy::dump(file, "/disp/" + std::to_string(inc), std::vector<double>(8, inc), {4, 2});
+        }
+    }
+
+    return 0;
+}
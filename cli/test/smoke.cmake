@@ -0,0 +1,55 @@
+# Smoke test of xdmfwrite-batch: option parsing, names of the XDMF-files, and exit codes.
+# Usage: cmake -DCLI=<xdmfwrite-batch> -DINPUT=<xdmfwrite-batch-input> -DDIR=<directory> -P smoke.cmake
+
+function(run expected)
+    execute_process(
+        COMMAND ${CLI} ${ARGN}
+        WORKING_DIRECTORY ${DIR}
+        RESULT_VARIABLE result
+        OUTPUT_VARIABLE output
+        ERROR_VARIABLE error)
+    if(NOT result EQUAL expected)
+        message(FATAL_ERROR "'${ARGN}' returned ${result} (expected ${expected}):\n${output}\n${error}")
+    endif()
+endfunction()
+
+function(require_file path)
+    if(NOT EXISTS "${DIR}/${path}")
+        message(FATAL_ERROR "'${path}' not written")
+    endif()
+endfunction()
+
+file(REMOVE_RECURSE ${DIR})
+file(MAKE_DIRECTORY ${DIR}/run.d)
+
+execute_process(
+    COMMAND ${INPUT} a.h5 data.v1.h5 run.d/noext
+    WORKING_DIRECTORY ${DIR}
+    RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "Unable to write input")
+endif()
+
+# options
+run(0 --help)
+run(2)
+run(2 --unknown a.h5)
+run(2 --type=Unknown a.h5)
+run(2 --list=non-existing.txt)
+
+# name.h5 gives name.xdmf, a dot in a directory is not an extension
+file(WRITE ${DIR}/list.txt "data.v1.h5\nrun.d/noext\n")
+run(0 --quiet --threads=2 --type=Quadrilateral --time=/time a.h5 --list=list.txt)
+require_file(a.xdmf)
+require_file(data.v1.xdmf)
+require_file(run.d/noext.xdmf)
+
+file(READ ${DIR}/a.xdmf content)
+if(NOT content MATCHES "Time Value=\"0.5")
+    message(FATAL_ERROR "Unexpected content of a.xdmf:\n${content}")
+endif()
+
+# a failing file gives a non-zero exit code, the other files are still written
+file(REMOVE ${DIR}/a.xdmf)
+run(1 --quiet non-existing.h5 a.h5)
+require_file(a.xdmf)
@@ -0,0 +1,366 @@
+/**
+Generate an XDMF-file for each of a list of HDF5-files, in parallel.
+See ``xdmfwrite-batch --help``.
+
+The layout of the HDF5-files is specified by the paths of the mesh and a pattern that matches
+the fields per increment, see XDMFWrite_HighFive::Discover().
+Each HDF5-file ``name.h5`` gives ``name.xdmf``.
+
+The HDF5-files are distributed over a pool of threads that steal files from each other when
+they run out of work.
+Reading from HDF5 is serialized (the HDF5 library is in general not thread-safe),
+composing, rendering, and writing the XDMF-files is done in parallel.
+*/
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <XDMFWrite_HighFive.hpp>
+
+namespace xh = XDMFWrite_HighFive;
+
+static const char* usage = R"(xdmfwrite-batch
+    Generate an XDMF-file for each of a list of HDF5-files.
+
+Usage:
+    xdmfwrite-batch [options] [--list=FILE] [FILE...]
+
+Arguments:
+    FILE            HDF5-file(s) (name.h5 gives name.xdmf).
+
+Options:
+    --list=FILE     File with one HDF5-file per line ("-" for stdin).
+    --geometry=P    Path of the Geometry DataSet [default: /coor].
+    --topology=P    Path of the Topology DataSet [default: /conn].
+    --type=T        Element type, e.g. Quadrilateral [default: Quadrilateral].
+    --pattern=R     Regular expression of the fields (name, increment) [default: /(\w+)/(\d+)].
+    --time=P        Path of the DataSet with the time of each increment [default: none].
+    --threads=N     Number of threads [default: number of hardware threads].
+    --quiet         Do not print the timing per file.
+    -h, --help      Show this help.
+)";
+
+struct Options
+{
+    std::vector<std::string> files;
+    std::string geometry = "/coor";
+    std::string topology = "/conn";
+    xh::ElementType type = xh::ElementType::Quadrilateral;
+    std::string pattern = "/(\\w+)/(\\d+)";
+    std::string time;
+    size_t threads = std::max(std::thread::hardware_concurrency(), 1u);
+    bool quiet = false;
+};
+
+struct Timing
+{
+    std::string file;
+    bool ok = false;
+    std::string error;
+    double read = 0.0; // seconds in HDF5 (including waiting for the lock)
+    double write = 0.0; // seconds composing, rendering, and writing the XDMF-file
+};
+
+void read_list(std::istream& stream, std::vector<std::string>& files)
+{
+    std::string line;
+    while (std::getline(stream, line)) {
+        if (line.size() > 0) {
+            files.push_back(line);
+        }
+    }
+}
+
+Options parse(int argc, char* argv[])
+{
+    Options ret;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        std::string key = arg.substr(0, arg.find('='));
+        std::string value = arg.find('=') == std::string::npos ? "" : arg.substr(arg.find('=') + 1);
+
+        if (arg == "-h" || arg == "--help") {
+            std::cout << usage;
+            std::exit(0);
+        }
+        else if (arg == "--quiet") {
+            ret.quiet = true;
+        }
+        else if (key == "--list") {
+            if (value == "-") {
+                read_list(std::cin, ret.files);
+            }
+            else {
+                std::ifstream list(value);
+                if (!list.is_open()) {
+                    throw std::runtime_error("Unable to open " + value);
+                }
+                read_list(list, ret.files);
+            }
+        }
+        else if (key == "--geometry") {
+            ret.geometry = value;
+        }
+        else if (key == "--topology") {
+            ret.topology = value;
+        }
+        else if (key == "--type") {
+            try {
+                ret.type = xh::element_type(value);
+            }
+            catch (const std::exception&) {
+                throw std::runtime_error("Unknown element type: " + value);
+            }
+        }
+        else if (key == "--pattern") {
+            ret.pattern = value;
+        }
+        else if (key == "--time") {
+            ret.time = value;
+        }
+        else if (key == "--threads") {
+            ret.threads = std::max(std::stoul(value), 1ul);
+        }
+        else if (arg.size() > 0 && arg[0] == '-') {
+            throw std::runtime_error("Unknown option: " + arg);
+        }
+        else {
+            ret.files.push_back(arg);
+        }
+    }
+
+    return ret;
+}
+
+std::string xdmf_name(const std::string& file)
+{
+    size_t dot = file.rfind('.');
+    size_t sep = file.find_last_of("/\\");
+
+    if (dot == std::string::npos || (sep != std::string::npos && dot < sep)) {
+        return file + ".xdmf";
+    }
+
+    return file.substr(0, dot) + ".xdmf";
+}
+
+std::string basename(const std::string& file)
+{
+    size_t sep = file.find_last_of("/\\");
+    return sep == std::string::npos ? file : file.substr(sep + 1);
+}
+
+// Queue of files (indices) of one thread.
+// The owner takes from the back, other threads steal from the front.
+class WorkQueue
+{
+public:
+    void push(size_t index)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_data.push_back(index);
+    }
+
+    bool pop(size_t& index)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_data.empty()) {
+            return false;
+        }
+        index = m_data.back();
+        m_data.pop_back();
+        return true;
+    }
+
+    bool steal(size_t& index)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_data.empty()) {
+            return false;
+        }
+        index = m_data.front();
+        m_data.pop_front();
+        return true;
+    }
+
+private:
+    std::mutex m_mutex;
+    std::deque<size_t> m_data;
+};
+
+double seconds(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// HDF5-file and its metadata, opened and closed while holding the lock on the HDF5 library.
+class Input
+{
+public:
+    Input(const std::string& filename, std::mutex& hdf5) : m_hdf5(hdf5)
+    {
+        std::lock_guard<std::mutex> lock(m_hdf5);
+        m_file.reset(new HighFive::File(filename, HighFive::File::ReadOnly));
+        m_cache.reset(new xh::MetadataCache(*m_file, basename(filename))); // relative to the XDMF-file
+    }
+
+    ~Input()
+    {
+        std::lock_guard<std::mutex> lock(m_hdf5);
+        m_cache.reset();
+        m_file.reset();
+    }
+
+    // Read the metadata of all DataSets, and the time of each increment (if "time" is specified).
+    void read(const Options& opts, std::vector<double>& time)
+    {
+        std::lock_guard<std::mutex> lock(m_hdf5);
+        m_cache->prefetch();
+        m_cache->get(opts.geometry);
+        m_cache->get(opts.topology);
+        if (opts.time.size() > 0) {
+            m_file->getDataSet(opts.time).read(time);
+            m_cache->invalidate(opts.time); // not a field
+        }
+    }
+
+    xh::MetadataCache& cache()
+    {
+        return *m_cache;
+    }
+
+private:
+    std::mutex& m_hdf5;
+    std::unique_ptr<HighFive::File> m_file;
+    std::unique_ptr<xh::MetadataCache> m_cache;
+};
+
+void process(const Options& opts, std::mutex& hdf5, Timing& timing)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    Input input(timing.file, hdf5);
+    std::vector<double> time;
+    input.read(opts, time);
+
+    timing.read = seconds(start);
+    start = std::chrono::steady_clock::now();
+
+    // no HDF5 I/O: all metadata is cached
+    xh::TimeSeries series = xh::Discover(
+        input.cache(), opts.geometry, opts.topology, opts.type, opts.pattern, time);
+
+    xh::write(xdmf_name(timing.file), series);
+
+    timing.write = seconds(start);
+    timing.ok = true;
+}
+
+int main(int argc, char* argv[])
+{
+    Options opts;
+
+    try {
+        opts = parse(argc, argv);
+    }
+    catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl << std::endl << usage;
+        return 2;
+    }
+
+    if (opts.files.empty()) {
+        std::cerr << usage;
+        return 2;
+    }
+
+    size_t nthreads = std::min(opts.threads, opts.files.size());
+    std::vector<Timing> timings(opts.files.size());
+    std::vector<WorkQueue> queues(nthreads);
+    std::mutex hdf5;
+    std::mutex output;
+
+    for (size_t i = 0; i < opts.files.size(); ++i) {
+        timings[i].file = opts.files[i];
+        queues[i % nthreads].push(i);
+    }
+
+    auto worker = [&](size_t id) {
+        while (true) {
+            size_t index;
+            bool found = queues[id].pop(index);
+
+            for (size_t j = 1; j < nthreads && !found; ++j) {
+                found = queues[(id + j) % nthreads].steal(index);
+            }
+
+            // all files have been distributed at the start: no work left anywhere
+            if (!found) {
+                return;
+            }
+
+            Timing& timing = timings[index];
+
+            try {
+                process(opts, hdf5, timing);
+            }
+            catch (const std::exception& e) {
+                timing.error = e.what();
+            }
+
+            std::lock_guard<std::mutex> lock(output);
+
+            if (!timing.ok) {
+                std::cerr << timing.file << ": " << timing.error << std::endl;
+            }
+            else if (!opts.quiet) {
+                std::cout << std::fixed << std::setprecision(4)
+                          << "read " << timing.read << " s, write " << timing.write << " s: "
+                          << timing.file << std::endl;
+            }
+        }
+    };
+
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> threads;
+    for (size_t id = 0; id < nthreads; ++id) {
+        threads.emplace_back(worker, id);
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    double total = seconds(start);
+    size_t failed = 0;
+    double read = 0.0;
+    double write = 0.0;
+
+    for (auto& timing : timings) {
+        failed += timing.ok ? 0 : 1;
+        read += timing.read;
+        write += timing.write;
+    }
+
+    std::cout << std::fixed << std::setprecision(4)
+              << opts.files.size() - failed << " files in " << total << " s using "
+              << nthreads << " threads (" << (opts.files.size() - failed) / total << " files/s)"
+              << std::endl
+              << "total read " << read << " s, total write " << write << " s" << std::endl;
+
+    if (failed > 0) {
+        std::cerr << failed << " files failed" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -15,18 +15,15 @@ int main()
         {1, 1},
         {1, 2}};
 
-    xt::xtensor<size_t,1> conn = xt::arange<size_t>(coor.shape(0));
-
     xt::xtensor<double,1> radius = xt::random::rand<double>({coor.shape(0)});
 
     H5Easy::File file("grid_structured.h5", H5Easy::File::Overwrite);
 
     H5Easy::dump(file, "/coor", coor);
-    H5Easy::dump(file, "/conn", conn);
     H5Easy::dump(file, "/radius", radius);
 
     auto grid = xh::Grid({
-        xh::Structured(file, "/coor", "/conn"),
+        xh::Structured(file, "/coor"),
         xh::Attribute(file, "/radius", xh::AttributeCenter::Node)});
 
     xh::write("grid_structured.xdmf", grid);
@@ -12,7 +12,29 @@ References:
 #ifndef XDMFWRITE_HIGHFIVE_H
 #define XDMFWRITE_HIGHFIVE_H
 
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <exception>
 #include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iterator>
+#include <limits>
+#include <locale>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <regex>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
 #include <highfive/H5Easy.hpp>
 
 /**
@@ -118,6 +140,24 @@ To change the default to e.g. 2::
     #endif
 #endif
 
+/**
+Enable SpatialCollection::gather() (requires MPI) using::
+
+    #define XDMFWRITE_HIGHFIVE_USE_MPI
+
+**before** including XDMFWrite_HighFive.
+*/
+#ifdef XDMFWRITE_HIGHFIVE_USE_MPI
+    #include <mpi.h>
+#endif
+
+#ifdef _WIN32
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h> // MoveFileExA (AsyncWriter)
+#endif
+
 namespace XDMFWrite_HighFive {
 
 /**
@@ -139,808 +179,6063 @@ Returns a string in which the string elements of a sequence have been joined by
 inline std::string join(const std::vector<std::string>& lines, const std::string& sep="\n");
 
 /**
-Concatenate lists.
-
-\param args Lists, specified as ``{...}``.
-\return Concatenated list.
+Element of an XDMF-file: an XML-element with attributes, text, and child elements.
+All fields (e.g. Geometry(), Topology(), Attribute()) and grids (e.g. Grid(), TimeSeries)
+are composed of Element-s.
+They are converted to text, with the correct indentation, only when they are written.
+
+An Element without tag is simply a sequence of elements
+(e.g. the result of concatenate()).
+An Element can also be constructed from a sequence of strings,
+and converted to a sequence of strings.
+This allows the use of Element-s and sequences of strings interchangeably.
 */
-template <class T>
-inline std::vector<T> concatenate(std::initializer_list<std::vector<T>> args);
+class Element
+{
+public:
 
-/**
-Specify the ElementType() for a certain Topology().
-*/
-enum class ElementType {
-    Polyvertex, ///< Polyvertex
-    Triangle, ///< Triangle
-    Quadrilateral, ///< Quadrilateral
-    Hexahedron ///< Hexahedron
+    /**
+    Constructor of an empty sequence of elements.
+    */
+    Element() = default;
+
+    /**
+    Constructor.
+
+    \param tag Tag of the element (e.g. ``"Geometry"``).
+    */
+    Element(const std::string& tag);
+
+    /**
+    Constructor.
+
+    \param tag Tag of the element (e.g. ``"Geometry"``).
+    \param attributes List of attributes, specified as ``{{"name", "value"}, ...}``.
+    \param text Text of the element.
+    */
+    Element(
+        const std::string& tag,
+        const std::vector<std::pair<std::string, std::string>>& attributes,
+        const std::string& text = "");
+
+    /**
+    Constructor from a sequence of strings.
+    The strings are written as they are (but with the correct indentation).
+
+    \param lines Sequence of strings.
+    */
+    Element(const std::vector<std::string>& lines);
+
+    /**
+    Set (or overwrite) an attribute.
+
+    \param name Name of the attribute.
+    \param value Value of the attribute.
+    \return Reference to this element.
+    */
+    inline Element& set(const std::string& name, const std::string& value);
+
+    /**
+    Set the text of the element.
+
+    \param text Text.
+    \return Reference to this element.
+    */
+    inline Element& set_text(const std::string& text);
+
+    /**
+    Add a child element.
+
+    \param child The child element.
+    \return Reference to this element.
+    */
+    inline Element& push_back(const Element& child);
+
+    /**
+    Add a child element.
+
+    \param child The child element.
+    \return Reference to this element.
+    */
+    inline Element& push_back(Element&& child);
+
+    /**
+    Tag of the element (empty for a sequence of elements).
+
+    \return Tag.
+    */
+    inline const std::string& tag() const;
+
+    /**
+    List of attributes.
+
+    \return List of pairs (name, value).
+    */
+    inline const std::vector<std::pair<std::string, std::string>>& attributes() const;
+
+    /**
+    Text of the element.
+
+    \return Text.
+    */
+    inline const std::string& text() const;
+
+    /**
+    Sequence of strings from which the element was constructed.
+
+    \return Sequence of strings.
+    */
+    inline const std::vector<std::string>& lines() const;
+
+    /**
+    Child elements.
+
+    \return List of elements.
+    */
+    inline const std::vector<Element>& children() const;
+
+    /**
+    Get sequence of strings to be used in an XDMF-file.
+
+    \return Sequence of strings to be used in an XDMF-file.
+    */
+    inline std::vector<std::string> get() const;
+
+    /**
+    Convert to sequence of strings, see get().
+
+    \return Sequence of strings to be used in an XDMF-file.
+    */
+    inline operator std::vector<std::string>() const;
+
+private:
+    std::string m_tag;
+    std::vector<std::pair<std::string, std::string>> m_attributes;
+    std::string m_text;
+    std::vector<std::string> m_lines;
+    std::vector<Element> m_children;
 };
 
 /**
-Specify the AttributeCenter() of a field.
-See: https://www.xdmf.org/index.php/XDMF_Model_and_Format#Attribute
+Check if two Element-s are written identically.
+
+\param a Element.
+\param b Element.
+\return ``true`` if both elements give the same sequence of strings.
 */
-enum class AttributeCenter {
-    Cell, ///< Cell.
-    Node ///< Node.
-};
+inline bool operator==(const Element& a, const Element& b);
 
 /**
-Interpret a DataSet as a Geometry().
-Other common terms for Geometry():
--   Nodal coordinates.
--   Vertices.
+Check if two Element-s are written differently.
 
-\param file An open and readable HighFive file.
-\param dataset Path to the DataSet.
-\return Sequence of strings to be used in an XDMF-file.
+\param a Element.
+\param b Element.
+\return ``true`` if both elements give a different sequence of strings.
 */
-inline std::vector<std::string> Geometry(
-    const HighFive::File& file,
-    const std::string& dataset);
+inline bool operator!=(const Element& a, const Element& b);
 
 /**
-Interpret a DataSet as a Topology().
-Other common terms for Topology():
--   Connectivity.
+Concatenate lists.
 
-\param file An open and readable HighFive file.
-\param dataset Path to the DataSet.
-\param type Element-type (see ElementType).
-\return Sequence of strings to be used in an XDMF-file.
+\param args Lists, specified as ``{...}``.
+\return Concatenated list.
 */
 template <class T>
-inline std::vector<std::string> Topology(
-    const HighFive::File& file,
-    const std::string& dataset,
-    const T& type);
+inline std::vector<T> concatenate(std::initializer_list<std::vector<T>> args);
 
 /**
-Interpret a DataSet as an Attribute().
-See: https://www.xdmf.org/index.php/XDMF_Model_and_Format#Attribute
-
-By default the path of the DataSet is used as name in the XDMF-file.
-An overload is available to specify a different name.
+Concatenate Element-s (e.g. fields Geometry(), Topology(), Attribute()) to a sequence of elements.
 
-\param file An open and readable HighFive file.
-\param dataset Path to the DataSet.
-\param center How to center the Attribute (see AttributeCenter()).
-\return Sequence of strings to be used in an XDMF-file.
+\param args Element-s, specified as ``{...}``.
+\return Sequence of elements.
 */
-template <class T>
-inline std::vector<std::string> Attribute(
-    const HighFive::File& file,
-    const std::string& dataset,
-    const T& center);
+inline Element concatenate(std::initializer_list<Element> args);
 
 /**
-Interpret a DataSet as an Attribute().
-See: https://www.xdmf.org/index.php/XDMF_Model_and_Format#Attribute
+Concatenate lists whose number is only known at runtime.
+The first list is moved, the others are moved into it (no deep copies of the items).
 
-\param file An open and readable HighFive file.
-\param dataset Path to the DataSet.
-\param center How to center the Attribute (see AttributeCenter()).
-\param name Name to use in the XDMF-file.
-\return Sequence of strings to be used in an XDMF-file.
+\param args Lists.
+\return Concatenated list.
 */
 template <class T>
-inline std::vector<std::string> Attribute(
-    const HighFive::File& file,
-    const std::string& dataset,
-    const T& center,
-    const std::string &name);
+inline std::vector<T> concatenate(std::vector<std::vector<T>>&& args);
 
 /**
-Combine fields (Geometry(), Topology(), Attribute()) to a single grid.
+Concatenate Element-s whose number is only known at runtime.
+The Element-s are moved (no deep copies).
 
-\param name
-    Name of the grid.
+\param args Element-s.
+\return Sequence of elements.
+*/
+inline Element concatenate(std::vector<Element>&& args);
 
-\param args
-    The fields (themselves a sequence of strings) to write.
-    An arbitrary number of string sequences can be combined using ``{...}``.
+/**
+Concatenate a range of Element-s.
+The Element-s are copied, unless ``std::make_move_iterator`` is used.
 
-\return
-    Sequence of strings to be used in an XDMF-file.
+\param first Iterator to the first Element.
+\param last Iterator past the last Element.
+\return Sequence of elements.
 */
-inline std::vector<std::string> Grid(
-    const std::string& name,
-    std::initializer_list<std::vector<std::string>> args);
+template <class Iterator>
+inline Element concatenate(Iterator first, Iterator last);
 
 /**
-Combine fields (Geometry(), Topology(), Attribute()) to a single grid.
-An overload is available to specify the name.
+Specify the ElementType() for a certain Topology().
+*/
+enum class ElementType {
+    Polyvertex, ///< Polyvertex
+    Triangle, ///< Triangle
+    Quadrilateral, ///< Quadrilateral
+    Hexahedron, ///< Hexahedron
+    Tetrahedron, ///< Tetrahedron
+    Pyramid, ///< Pyramid
+    Wedge, ///< Wedge
+    Triangle_6, ///< Quadratic triangle
+    Quadrilateral_8, ///< Quadratic (serendipity) quadrilateral
+    Hexahedron_20 ///< Quadratic (serendipity) hexahedron
+};
 
-\param args
-    The fields (themselves a sequence of strings) to write.
-    An arbitrary number if string sequences can be combined using ``{...}``.
+/**
+Get an ElementType() from its name as written in an XDMF-file (e.g. ``"Quadrilateral"``).
 
-\return Sequence of strings to be used in an XDMF-file.
+\param name Name of the ElementType.
+\return ElementType.
 */
-inline std::vector<std::string> Grid(
-    std::initializer_list<std::vector<std::string>> args);
+inline ElementType element_type(const std::string& name);
 
 /**
-Combine a series of fields (e.g. Geometry(), Topology(), and Attribute) to a time-series.
+Specify the AttributeCenter() of a field.
+See: https://www.xdmf.org/index.php/XDMF_Model_and_Format#Attribute
 */
-class TimeSeries
+enum class AttributeCenter {
+    Cell, ///< Cell.
+    Node ///< Node.
+};
+
+/**
+Metadata of a DataSet, as needed to write it in an XDMF-file.
+*/
+struct Metadata
+{
+    std::string filename; ///< Name of the HDF5-file.
+    std::string dataset; ///< Path to the DataSet.
+    std::vector<size_t> shape; ///< Shape of the DataSet.
+    std::string number_type; ///< XDMF NumberType (e.g. "Float", "Int", "UInt"), empty if unknown.
+    size_t precision = 0; ///< XDMF Precision (number of bytes per item), zero if unknown.
+};
+
+/**
+Cache of the Metadata of the DataSets in a HighFive file.
+Use it in place of the file in Geometry(), Topology(), Attribute(), Structured(),
+and Unstructured() to read the metadata of each DataSet only once.
+
+The metadata of a DataSet is read when it is first requested (by get()),
+or for all DataSets at once using prefetch().
+Use invalidate() or clear() if DataSets are (re)written after they were cached.
+*/
+class MetadataCache
 {
 public:
 
     /**
     Constructor.
-    An overload is available to specify the name of the TimeSeries.
+
+    \param file An open and readable HighFive file.
     */
-    TimeSeries() = default;
+    MetadataCache(const HighFive::File& file);
 
     /**
-    Constructor, allowing a custom name of the TimeSeries.
+    Constructor, allowing the filename in the XDMF-file to differ from that of the open file
+    (e.g. a path relative to the XDMF-file).
 
-    \param name Name of the TimeSeries.
+    \param file An open and readable HighFive file.
+    \param filename The filename to write in the XDMF-file.
     */
-    TimeSeries(const std::string& name);
+    MetadataCache(const HighFive::File& file, const std::string& filename);
 
     /**
-    Add a time-step given by a combination of fields (e.g. Geometry(), Topology(), and Attribute()).
+    Get the Metadata of a DataSet, reading it from the file if it is not yet cached.
 
-    \param name Name of the increment.
-    \param time Time value of the increment.
-    \param args The fields (themselves a sequence of strings) to write.
-    * An arbitrary number if string sequences can be combined using {...}.
+    \param dataset Path to the DataSet.
+    \return Metadata.
     */
-    template <class T>
-    inline void push_back(
-        const std::string& name,
-        const T& time,
-        std::initializer_list<std::vector<std::string>> args);
+    inline const Metadata& get(const std::string& dataset);
 
     /**
-    Add a time-step given by a combination of fields (e.g. Geometry(), Topology(), and Attribute()).
-    An overload is available to specify the time and name of the increment.
+    Check if the Metadata of a DataSet is cached.
 
-    \param time
-        Time value of the increment.
+    \param dataset Path to the DataSet.
+    \return ``true`` if the DataSet is cached.
+    */
+    inline bool contains(const std::string& dataset) const;
 
-    \param args
-        The fields (themselves a sequence of strings) to write.
-        An arbitrary number if string sequences can be combined using ``{...}``.
+    /**
+    Read the Metadata of all DataSets in the file in one traversal.
+    DataSets are stored by their absolute path (e.g. ``"/coor"``).
     */
-    template <class T>
-    inline void push_back(
-        const T& time,
-        std::initializer_list<std::vector<std::string>> args);
+    inline void prefetch();
 
     /**
-    Add a time-step given by a combination of fields (e.g. Geometry(), Topology(), and Attribute()).
-    An overload is available to specify the time and name of the increment.
+    Read the Metadata of all DataSets in a group (recursively) in one traversal.
 
-    \param args
-        The fields (themselves a sequence of strings) to write.
-        An arbitrary number if string sequences can be combined using ``{...}``.
+    \param group Path to the group.
+    */
+    inline void prefetch(const std::string& group);
 
-    \return
-        Sequence of strings to be used in an XDMF-file.
+    /**
+    Remove a DataSet from the cache.
+
+    \param dataset Path to the DataSet.
     */
-    inline void push_back(
-        std::initializer_list<std::vector<std::string>> args);
+    inline void invalidate(const std::string& dataset);
 
+    /**
+    Remove all DataSets from the cache.
+    */
+    inline void clear();
 
     /**
-    Get sequence of strings to be used in an XDMF-file.
+    The file to which the cache is bound.
 
-    \return Sequence of strings to be used in an XDMF-file.
+    \return HighFive file.
     */
-    inline std::vector<std::string> get() const;
+    inline const HighFive::File& file() const;
+
+    /**
+    Paths of the cached DataSets (sorted).
+
+    \return List of paths.
+    */
+    inline std::vector<std::string> datasets() const;
 
 private:
-    std::vector<std::string> m_lines;
-    std::string m_name = "TimeSeries";
-    size_t m_n = 0;
+    HighFive::File m_file;
+    std::string m_filename;
+    std::map<std::string, Metadata> m_data;
 };
 
 /**
-Interpret a DataSets as a Structured (individual points). This is simply short for the
-concatenation of:
+Selection of part of a DataSet, written as a HyperSlab DataItem.
+This allows for example to store a field for all increments in one DataSet of shape
+``[time, ...]`` and to refer to the data of one increment in the XDMF-file.
+See: https://www.xdmf.org/index.php/XDMF_Model_and_Format#HyperSlab
+*/
+struct HyperSlab
+{
+    /**
+    Constructor.
+    Select ``count`` items with a certain ``stride``, starting at ``start`` (along each axis).
 
--   ``Geometry(file, "/coor")`` and
--   ``Topology(file, "/conn", ElementType::Polyvertex)``.
+    \param data Metadata of the (entire) DataSet.
+    \param start Start index along each axis.
+    \param stride Stride along each axis.
+    \param count Number of items along each axis.
+    \param shape Shape of the selection (default: ``count``), e.g. without axes of length one.
+    */
+    HyperSlab(
+        const Metadata& data,
+        const std::vector<size_t>& start,
+        const std::vector<size_t>& stride,
+        const std::vector<size_t>& count,
+        const std::vector<size_t>& shape = {});
 
-\param file An open and readable HighFive file.
-\param dataset_geometry Path to the Geometry() DataSet.
-\param dataset_topology Path to a mock Topology() arange(N), with N the number of nodes (vertices).
-\return Sequence of strings to be used in an XDMF-file.
-*/
-inline std::vector<std::string> Structured(
-    const HighFive::File& file,
-    const std::string& dataset_geometry,
-    const std::string& dataset_topology);
+    /**
+    Constructor.
+    Select item ``index`` along the first axis (e.g. the time axis of a DataSet ``[time, ...]``).
+    The result has the shape of the DataSet without the first axis.
 
-/**
-Interpret a DataSets as a Unstructured
-(Geometry() and Topology() / nodal-coordinates and connectivity). This is simply short for the
-concatenation of
--   ``Geometry(file, "/coor")`` and
--   ``Topology(file, "/conn", type)``.
+    \param data Metadata of the (entire) DataSet.
+    \param index Index along the first axis.
+    */
+    HyperSlab(const Metadata& data, size_t index);
 
-\param file An open and readable HighFive file.
-\param dataset_geometry Path to the Geometry() DataSet.
-\param dataset_topology Path to the Topology() DataSet.
-\param type Element-type (see ElementType()).
-\return Sequence of strings to be used in an XDMF-file.
+    Metadata data; ///< Metadata of the (entire) DataSet.
+    std::vector<size_t> start; ///< Start index along each axis.
+    std::vector<size_t> stride; ///< Stride along each axis.
+    std::vector<size_t> count; ///< Number of items along each axis.
+    std::vector<size_t> shape; ///< Shape of the selection.
+};
+
+/**
+\cond
 */
-template <class T>
-inline std::vector<std::string> Unstructured(
+namespace detail {
+
+    // SFINAE helper: check if a template argument has a "shape()" (e.g. xt::xtensor).
+    template <class T, class = void>
+    struct has_shape : std::false_type
+    {
+    };
+
+    template <class T>
+    struct has_shape<T, decltype(void(std::declval<const T&>().shape()))> : std::true_type
+    {
+    };
+
+} // namespace detail
+/**
+\endcond
+*/
+
+/**
+Interpret a DataSet as a Geometry().
+Other common terms for Geometry():
+-   Nodal coordinates.
+-   Vertices.
+
+\param file An open and readable HighFive file.
+\param dataset Path to the DataSet.
+\return Element to be used in an XDMF-file.
+*/
+inline Element Geometry(
+    const HighFive::File& file,
+    const std::string& dataset);
+
+/**
+Interpret a DataSet as a Geometry(), using cached metadata.
+
+\param cache Metadata of the file (see MetadataCache).
+\param dataset Path to the DataSet.
+\return Element to be used in an XDMF-file.
+*/
+inline Element Geometry(
+    MetadataCache& cache,
+    const std::string& dataset);
+
+/**
+Interpret a DataSet as a Geometry(), from its metadata.
+
+\param data Metadata of the DataSet.
+\return Element to be used in an XDMF-file.
+*/
+inline Element Geometry(
+    const Metadata& data);
+
+/**
+Interpret a DataSet as a Geometry(), given its shape.
+No HDF5 I/O is done.
+
+\param filename Name of the HDF5-file.
+\param dataset Path to the DataSet.
+\param shape Shape of the DataSet.
+\return Element to be used in an XDMF-file.
+*/
+inline Element Geometry(
+    const std::string& filename,
+    const std::string& dataset,
+    const std::vector<size_t>& shape);
+
+/**
+Interpret a DataSet as a Geometry(), given the data that is (or will be) written to it.
+The shape and type are taken from the data, no HDF5 I/O is done.
+
+\param filename Name of the HDF5-file.
+\param dataset Path to the DataSet.
+\param data The data (any container with ``shape()``, e.g. ``xt::xtensor``).
+\return Element to be used in an XDMF-file.
+*/
+template <class E, typename = std::enable_if_t<detail::has_shape<E>::value>>
+inline Element Geometry(
+    const std::string& filename,
+    const std::string& dataset,
+    const E& data);
+
+/**
+Interpret part of a DataSet as a Geometry().
+
+\param slab Selection of the DataSet (see HyperSlab).
+\return Element to be used in an XDMF-file.
+*/
+inline Element Geometry(
+    const HyperSlab& slab);
+
+/**
+Interpret item ``index`` along the first axis of a DataSet as a Geometry().
+E.g. the nodal-coordinates of increment ``index`` of a DataSet ``[time, nodes, dim]``.
+
+\param file An open and readable HighFive file.
+\param dataset Path to the DataSet.
+\param index Index along the first axis.
+\return Element to be used in an XDMF-file.
+*/
+inline Element Geometry(
+    const HighFive::File& file,
+    const std::string& dataset,
+    size_t index);
+
+/**
+Interpret item ``index`` along the first axis of a DataSet as a Geometry(),
+using cached metadata.
+
+\param cache Metadata of the file (see MetadataCache).
+\param dataset Path to the DataSet.
+\param index Index along the first axis.
+\return Element to be used in an XDMF-file.
+*/
+inline Element Geometry(
+    MetadataCache& cache,
+    const std::string& dataset,
+    size_t index);
+
+/**
+Interpret separate DataSets per component (e.g. ``{"/x", "/y", "/z"}``) as a Geometry().
+This writes a ``X_Y`` or ``X_Y_Z`` Geometry(), such that the components need not be interleaved.
+
+\param file An open and readable HighFive file.
+\param datasets Path to the (one-dimensional) DataSet of each component.
+\return Element to be used in an XDMF-file.
+*/
+inline Element Geometry(
+    const HighFive::File& file,
+    std::initializer_list<std::string> datasets);
+
+/**
+Interpret separate DataSets per component as a Geometry(), using cached metadata.
+
+\param cache Metadata of the file (see MetadataCache).
+\param datasets Path to the (one-dimensional) DataSet of each component.
+\return Element to be used in an XDMF-file.
+*/
+inline Element Geometry(
+    MetadataCache& cache,
+    std::initializer_list<std::string> datasets);
+
+/**
+Interpret separate DataSets per component as a Geometry(), from their metadata.
+
+\param components Metadata of the (one-dimensional) DataSet of each component.
+\return Element to be used in an XDMF-file.
+*/
+inline Element Geometry(
+    const std::vector<Metadata>& components);
+
+/**
+Interpret a DataSet as a Topology().
+Other common terms for Topology():
+-   Connectivity.
+
+\param file An open and readable HighFive file.
+\param dataset Path to the DataSet.
+\param type Element-type (see ElementType).
+\return Element to be used in an XDMF-file.
+*/
+template <class T>
+inline Element Topology(
+    const HighFive::File& file,
+    const std::string& dataset,
+    const T& type);
+
+/**
+Interpret a DataSet as a Topology(), using cached metadata.
+
+\param cache Metadata of the file (see MetadataCache).
+\param dataset Path to the DataSet.
+\param type Element-type (see ElementType).
+\return Element to be used in an XDMF-file.
+*/
+template <class T>
+inline Element Topology(
+    MetadataCache& cache,
+    const std::string& dataset,
+    const T& type);
+
+/**
+Interpret a DataSet as a Topology(), from its metadata.
+
+\param data Metadata of the DataSet.
+\param type Element-type (see ElementType).
+\return Element to be used in an XDMF-file.
+*/
+template <class T>
+inline Element Topology(
+    const Metadata& data,
+    const T& type);
+
+/**
+Interpret a DataSet as a Topology(), given its shape.
+No HDF5 I/O is done.
+
+\param filename Name of the HDF5-file.
+\param dataset Path to the DataSet.
+\param shape Shape of the DataSet.
+\param type Element-type (see ElementType).
+\return Element to be used in an XDMF-file.
+*/
+template <class T>
+inline Element Topology(
+    const std::string& filename,
+    const std::string& dataset,
+    const std::vector<size_t>& shape,
+    const T& type);
+
+/**
+Interpret a DataSet as a Topology(), given the data that is (or will be) written to it.
+The shape and type are taken from the data, no HDF5 I/O is done.
+
+\param filename Name of the HDF5-file.
+\param dataset Path to the DataSet.
+\param data The data (any container with ``shape()``, e.g. ``xt::xtensor``).
+\param type Element-type (see ElementType).
+\return Element to be used in an XDMF-file.
+*/
+template <class E, class T, typename = std::enable_if_t<detail::has_shape<E>::value>>
+inline Element Topology(
+    const std::string& filename,
+    const std::string& dataset,
+    const E& data,
+    const T& type);
+
+/**
+Topology() without DataSet, only for ``ElementType::Polyvertex`` (individual points).
+Each point is its own element, see Structured().
+
+\param type Element-type: ``ElementType::Polyvertex``.
+\param number_of_elements Number of points.
+\return Element to be used in an XDMF-file.
+*/
+inline Element Topology(
+    ElementType type,
+    size_t number_of_elements);
+
+/**
+Interpret a DataSet as a Topology() with elements of different types (``Mixed``).
+The DataSet is one flat list with, for each element, its XDMF type code followed by its nodes
+(for a Polyvertex: type code, number of nodes, nodes), see mixed_connectivity().
+
+\param file An open and readable HighFive file.
+\param dataset Path to the DataSet.
+\param number_of_elements Number of elements.
+\return Element to be used in an XDMF-file.
+*/
+inline Element MixedTopology(
+    const HighFive::File& file,
+    const std::string& dataset,
+    size_t number_of_elements);
+
+/**
+Interpret a DataSet as a Topology() with elements of different types, using cached metadata.
+
+\param cache Metadata of the file (see MetadataCache).
+\param dataset Path to the DataSet.
+\param number_of_elements Number of elements.
+\return Element to be used in an XDMF-file.
+*/
+inline Element MixedTopology(
+    MetadataCache& cache,
+    const std::string& dataset,
+    size_t number_of_elements);
+
+/**
+Interpret a DataSet as a Topology() with elements of different types, from its metadata.
+
+\param data Metadata of the DataSet.
+\param number_of_elements Number of elements.
+\return Element to be used in an XDMF-file.
+*/
+inline Element MixedTopology(
+    const Metadata& data,
+    size_t number_of_elements);
+
+/**
+Encode the connectivity of elements of one type to be used in a MixedTopology().
+The connectivity of different types is combined using concatenate(), for example::
+
+    auto conn = concatenate({
+        mixed_connectivity(ElementType::Triangle, tri),
+        mixed_connectivity(ElementType::Quadrilateral, quad)});
+
+    H5Easy::dump(file, "/conn", conn);
+
+    MixedTopology(file, "/conn", tri.shape(0) + quad.shape(0));
+
+\param type Element-type (see ElementType).
+\param conn
+    Connectivity ``[elements, nodes-per-element]``
+    (any contiguous row-major container with ``shape()`` and ``data()``, e.g. ``xt::xtensor``).
+\return Flat connectivity.
+*/
+template <class T, class E>
+inline std::vector<size_t> mixed_connectivity(const T& type, const E& conn);
+
+/**
+Interpret a DataSet as an Attribute().
+See: https://www.xdmf.org/index.php/XDMF_Model_and_Format#Attribute
+
+The type of Attribute follows from the shape of the DataSet:
+
+-   ``[n]``: Scalar.
+-   ``[n, 6]``: Tensor6 (symmetric tensor).
+-   ``[n, d]``: Vector.
+-   ``[n, 3, 3]``: Tensor.
+-   ``[n, a, b]``: Matrix.
+
+By default the path of the DataSet is used as name in the XDMF-file.
+An overload is available to specify a different name.
+
+\param file An open and readable HighFive file.
+\param dataset Path to the DataSet.
+\param center How to center the Attribute (see AttributeCenter()).
+\return Element to be used in an XDMF-file.
+*/
+template <class T>
+inline Element Attribute(
+    const HighFive::File& file,
+    const std::string& dataset,
+    const T& center);
+
+/**
+Interpret a DataSet as an Attribute().
+See: https://www.xdmf.org/index.php/XDMF_Model_and_Format#Attribute
+
+\param file An open and readable HighFive file.
+\param dataset Path to the DataSet.
+\param center How to center the Attribute (see AttributeCenter()).
+\param name Name to use in the XDMF-file.
+\return Element to be used in an XDMF-file.
+*/
+template <class T>
+inline Element Attribute(
+    const HighFive::File& file,
+    const std::string& dataset,
+    const T& center,
+    const std::string &name);
+
+/**
+Interpret a DataSet as an Attribute(), using cached metadata.
+
+\param cache Metadata of the file (see MetadataCache).
+\param dataset Path to the DataSet.
+\param center How to center the Attribute (see AttributeCenter()).
+\return Element to be used in an XDMF-file.
+*/
+template <class T>
+inline Element Attribute(
+    MetadataCache& cache,
+    const std::string& dataset,
+    const T& center);
+
+/**
+Interpret a DataSet as an Attribute(), using cached metadata.
+
+\param cache Metadata of the file (see MetadataCache).
+\param dataset Path to the DataSet.
+\param center How to center the Attribute (see AttributeCenter()).
+\param name Name to use in the XDMF-file.
+\return Element to be used in an XDMF-file.
+*/
+template <class T>
+inline Element Attribute(
+    MetadataCache& cache,
+    const std::string& dataset,
+    const T& center,
+    const std::string& name);
+
+/**
+Interpret a DataSet as an Attribute(), from its metadata.
+The path of the DataSet is used as name in the XDMF-file.
+
+\param data Metadata of the DataSet.
+\param center How to center the Attribute (see AttributeCenter()).
+\return Element to be used in an XDMF-file.
+*/
+template <class T>
+inline Element Attribute(
+    const Metadata& data,
+    const T& center);
+
+/**
+Interpret a DataSet as an Attribute(), from its metadata.
+
+\param data Metadata of the DataSet.
+\param center How to center the Attribute (see AttributeCenter()).
+\param name Name to use in the XDMF-file.
+\return Element to be used in an XDMF-file.
+*/
+template <class T>
+inline Element Attribute(
+    const Metadata& data,
+    const T& center,
+    const std::string& name);
+
+/**
+Interpret a DataSet as an Attribute(), given its shape.
+The path of the DataSet is used as name in the XDMF-file.
+No HDF5 I/O is done.
+
+\param filename Name of the HDF5-file.
+\param dataset Path to the DataSet.
+\param shape Shape of the DataSet.
+\param center How to center the Attribute (see AttributeCenter()).
+\return Element to be used in an XDMF-file.
+*/
+template <class T>
+inline Element Attribute(
+    const std::string& filename,
+    const std::string& dataset,
+    const std::vector<size_t>& shape,
+    const T& center);
+
+/**
+Interpret a DataSet as an Attribute(), given its shape.
+No HDF5 I/O is done.
+
+\param filename Name of the HDF5-file.
+\param dataset Path to the DataSet.
+\param shape Shape of the DataSet.
+\param center How to center the Attribute (see AttributeCenter()).
+\param name Name to use in the XDMF-file.
+\return Element to be used in an XDMF-file.
+*/
+template <class T>
+inline Element Attribute(
+    const std::string& filename,
+    const std::string& dataset,
+    const std::vector<size_t>& shape,
+    const T& center,
+    const std::string& name);
+
+/**
+Interpret a DataSet as an Attribute(), given the data that is (or will be) written to it.
+The shape and type are taken from the data, no HDF5 I/O is done.
+The path of the DataSet is used as name in the XDMF-file.
+
+\param filename Name of the HDF5-file.
+\param dataset Path to the DataSet.
+\param data The data (any container with ``shape()``, e.g. ``xt::xtensor``).
+\param center How to center the Attribute (see AttributeCenter()).
+\return Element to be used in an XDMF-file.
+*/
+template <class E, class T, typename = std::enable_if_t<detail::has_shape<E>::value>>
+inline Element Attribute(
+    const std::string& filename,
+    const std::string& dataset,
+    const E& data,
+    const T& center);
+
+/**
+Interpret a DataSet as an Attribute(), given the data that is (or will be) written to it.
+The shape and type are taken from the data, no HDF5 I/O is done.
+
+\param filename Name of the HDF5-file.
+\param dataset Path to the DataSet.
+\param data The data (any container with ``shape()``, e.g. ``xt::xtensor``).
+\param center How to center the Attribute (see AttributeCenter()).
+\param name Name to use in the XDMF-file.
+\return Element to be used in an XDMF-file.
+*/
+template <class E, class T, typename = std::enable_if_t<detail::has_shape<E>::value>>
+inline Element Attribute(
+    const std::string& filename,
+    const std::string& dataset,
+    const E& data,
+    const T& center,
+    const std::string& name);
+
+/**
+Interpret part of a DataSet as an Attribute().
+The path of the DataSet is used as name in the XDMF-file.
+
+\param slab Selection of the DataSet (see HyperSlab).
+\param center How to center the Attribute (see AttributeCenter()).
+\return Element to be used in an XDMF-file.
+*/
+template <class T>
+inline Element Attribute(
+    const HyperSlab& slab,
+    const T& center);
+
+/**
+Interpret part of a DataSet as an Attribute().
+
+\param slab Selection of the DataSet (see HyperSlab).
+\param center How to center the Attribute (see AttributeCenter()).
+\param name Name to use in the XDMF-file.
+\return Element to be used in an XDMF-file.
+*/
+template <class T>
+inline Element Attribute(
+    const HyperSlab& slab,
+    const T& center,
+    const std::string& name);
+
+/**
+Interpret item ``index`` along the first axis of a DataSet as an Attribute().
+E.g. the field at increment ``index`` of a DataSet ``[time, nodes, ...]``.
+The path of the DataSet is used as name in the XDMF-file.
+
+\param file An open and readable HighFive file.
+\param dataset Path to the DataSet.
+\param index Index along the first axis.
+\param center How to center the Attribute (see AttributeCenter()).
+\return Element to be used in an XDMF-file.
+*/
+template <class T>
+inline Element Attribute(
+    const HighFive::File& file,
+    const std::string& dataset,
+    size_t index,
+    const T& center);
+
+/**
+Interpret item ``index`` along the first axis of a DataSet as an Attribute().
+
+\param file An open and readable HighFive file.
+\param dataset Path to the DataSet.
+\param index Index along the first axis.
+\param center How to center the Attribute (see AttributeCenter()).
+\param name Name to use in the XDMF-file.
+\return Element to be used in an XDMF-file.
+*/
+template <class T>
+inline Element Attribute(
+    const HighFive::File& file,
+    const std::string& dataset,
+    size_t index,
+    const T& center,
+    const std::string& name);
+
+/**
+Interpret item ``index`` along the first axis of a DataSet as an Attribute(),
+using cached metadata.
+The path of the DataSet is used as name in the XDMF-file.
+
+\param cache Metadata of the file (see MetadataCache).
+\param dataset Path to the DataSet.
+\param index Index along the first axis.
+\param center How to center the Attribute (see AttributeCenter()).
+\return Element to be used in an XDMF-file.
+*/
+template <class T>
+inline Element Attribute(
+    MetadataCache& cache,
+    const std::string& dataset,
+    size_t index,
+    const T& center);
+
+/**
+Interpret item ``index`` along the first axis of a DataSet as an Attribute(),
+using cached metadata.
+
+\param cache Metadata of the file (see MetadataCache).
+\param dataset Path to the DataSet.
+\param index Index along the first axis.
+\param center How to center the Attribute (see AttributeCenter()).
+\param name Name to use in the XDMF-file.
+\return Element to be used in an XDMF-file.
+*/
+template <class T>
+inline Element Attribute(
+    MetadataCache& cache,
+    const std::string& dataset,
+    size_t index,
+    const T& center,
+    const std::string& name);
+
+/**
+Interpret separate DataSets per component (e.g. ``{"/ux", "/uy", "/uz"}``) as an Attribute().
+The components are joined using a Function DataItem (``JOIN($0, $1, $2)``),
+such that they need not be interleaved.
+
+\param file An open and readable HighFive file.
+\param datasets Path to the (one-dimensional) DataSet of each component.
+\param center How to center the Attribute (see AttributeCenter()).
+\param name Name to use in the XDMF-file.
+\return Element to be used in an XDMF-file.
+*/
+template <class T>
+inline Element Attribute(
+    const HighFive::File& file,
+    std::initializer_list<std::string> datasets,
+    const T& center,
+    const std::string& name);
+
+/**
+Interpret separate DataSets per component as an Attribute(), using cached metadata.
+
+\param cache Metadata of the file (see MetadataCache).
+\param datasets Path to the (one-dimensional) DataSet of each component.
+\param center How to center the Attribute (see AttributeCenter()).
+\param name Name to use in the XDMF-file.
+\return Element to be used in an XDMF-file.
+*/
+template <class T>
+inline Element Attribute(
+    MetadataCache& cache,
+    std::initializer_list<std::string> datasets,
+    const T& center,
+    const std::string& name);
+
+/**
+Interpret separate DataSets per component as an Attribute(), from their metadata.
+
+\param components Metadata of the (one-dimensional) DataSet of each component.
+\param center How to center the Attribute (see AttributeCenter()).
+\param name Name to use in the XDMF-file.
+\return Element to be used in an XDMF-file.
+*/
+template <class T>
+inline Element Attribute(
+    const std::vector<Metadata>& components,
+    const T& center,
+    const std::string& name);
+
+/**
+A field stored for all increments in one extendible DataSet of shape ``[time, ...]``.
+Each append() writes one increment (a single HyperSlab write) and returns the selection of
+that increment, to be used in Geometry() or Attribute().
+For example::
+
+    AppendableField<double> disp(file, "/disp", {nnode, 2});
+
+    for (...) {
+        series.push_back({mesh, Attribute(disp.append(u), AttributeCenter::Node, "disp")});
+    }
+
+If the DataSet already exists it is opened, and new increments are appended to it.
+The number of increments written is stored as attribute ``"size"`` of the DataSet,
+such that room reserved by ``growth > 1`` is not mistaken for data when the DataSet is reopened.
+*/
+template <class T>
+class AppendableField
+{
+public:
+
+    /**
+    Constructor.
+
+    \param file An open and writable HighFive file.
+    \param dataset Path to the DataSet.
+    \param shape Shape of one increment (the DataSet has shape ``[time, shape...]``).
+    \param chunk Chunk shape of the DataSet (default: one increment ``[1, shape...]``).
+    \param growth Number of increments by which the DataSet is extended when it is full.
+    */
+    AppendableField(
+        HighFive::File& file,
+        const std::string& dataset,
+        const std::vector<size_t>& shape,
+        const std::vector<size_t>& chunk = {},
+        size_t growth = 1);
+
+    /**
+    Write one increment.
+
+    \param data The data (any contiguous row-major container with ``size()`` and ``data()``).
+    \return Selection of the increment (see HyperSlab).
+    */
+    template <class E>
+    inline HyperSlab append(const E& data);
+
+    /**
+    Selection of an increment that was written before.
+
+    \param index Index of the increment.
+    \return Selection of the increment (see HyperSlab).
+    */
+    inline HyperSlab slab(size_t index) const;
+
+    /**
+    Number of increments written.
+
+    \return Number of increments.
+    */
+    inline size_t size() const;
+
+    /**
+    Metadata of the increments written.
+    Note that if ``growth > 1`` the DataSet may have room for more increments,
+    see shrink_to_fit().
+
+    \return Metadata.
+    */
+    inline Metadata metadata() const;
+
+    /**
+    Resize the DataSet to the number of increments written.
+    The selections returned by append() and slab() remain valid.
+    */
+    inline void shrink_to_fit();
+
+private:
+    HighFive::DataSet m_dataset;
+    Metadata m_data; // shape[0]: number of increments written
+    size_t m_capacity; // number of increments for which the DataSet has room
+    size_t m_size;
+    size_t m_growth;
+};
+
+/**
+A field with a variable number of items (e.g. particles) per increment.
+The items of all increments are stored in one extendible DataSet ``[items, shape...]``,
+alongside a DataSet with the offset of each increment (``offsets[i]`` to ``offsets[i + 1]``).
+Each append() writes one increment and returns the selection of that increment,
+to be used in Structured(), Geometry(), or Attribute().
+For example::
+
+    RaggedField<double> coor(file, "/coor", {3});
+    RaggedField<double> mass(file, "/mass");
+
+    for (...) {
+        series.push_back({
+            Structured(coor.append(x)),
+            Attribute(mass.append(m), AttributeCenter::Node, "mass")});
+    }
+
+If the DataSets already exist they are opened, and new increments are appended to them.
+*/
+template <class T>
+class RaggedField
+{
+public:
+
+    /**
+    Constructor.
+
+    \param file An open and writable HighFive file.
+    \param dataset Path to the DataSet.
+    \param shape Shape of one item (e.g. ``{3}`` for coordinates, ``{}`` for a scalar).
+    \param offsets Path to the DataSet with offsets (default: ``dataset + "_offsets"``).
+    \param chunk Number of items per chunk.
+    */
+    RaggedField(
+        HighFive::File& file,
+        const std::string& dataset,
+        const std::vector<size_t>& shape = {},
+        const std::string& offsets = "",
+        size_t chunk = 1024);
+
+    /**
+    Write one increment.
+
+    \param data The data (any contiguous row-major container with ``size()`` and ``data()``).
+    \return Selection of the increment (see HyperSlab).
+    */
+    template <class E>
+    inline HyperSlab append(const E& data);
+
+    /**
+    Selection of an increment that was written before.
+
+    \param index Index of the increment.
+    \return Selection of the increment (see HyperSlab).
+    */
+    inline HyperSlab slab(size_t index) const;
+
+    /**
+    Number of increments written.
+
+    \return Number of increments.
+    */
+    inline size_t size() const;
+
+    /**
+    Metadata of the DataSet.
+
+    \return Metadata.
+    */
+    inline Metadata metadata() const;
+
+private:
+    HighFive::DataSet m_dataset;
+    HighFive::DataSet m_offsets;
+    Metadata m_data;
+    std::vector<size_t> m_index;
+    size_t m_size;
+};
+
+/**
+Stitch DataSets (e.g. one per MPI-rank, possibly in different files) along the first axis
+to one HDF5 Virtual DataSet (without copying data).
+The result can be used as any DataSet, e.g. ``Geometry(VirtualDataSet(...))``,
+such that the XDMF-file contains one global grid.
+The sources are given by their Metadata (see e.g. MetadataCache::get()),
+they must all have the same type and the same shape except along the first axis.
+
+Note that the data is not modified: a connectivity (Topology()) should already be numbered
+globally (i.e. offset by the number of nodes of the preceding sources).
+
+\param file An open and writable HighFive file.
+\param dataset Path of the Virtual DataSet.
+\param sources Metadata of the source DataSets.
+\return Metadata of the Virtual DataSet.
+*/
+inline Metadata VirtualDataSet(
+    HighFive::File& file,
+    const std::string& dataset,
+    const std::vector<Metadata>& sources);
+
+/**
+Combine fields (Geometry(), Topology(), Attribute()) to a single grid.
+
+\param name
+    Name of the grid.
+
+\param args
+    The fields (Element-s or sequences of strings) to write.
+    An arbitrary number of fields can be combined using ``{...}``.
+
+\return
+    Element to be used in an XDMF-file.
+*/
+inline Element Grid(
+    const std::string& name,
+    std::initializer_list<Element> args);
+
+/**
+Combine fields (Geometry(), Topology(), Attribute()) to a single grid.
+An overload is available to specify the name.
+
+\param args
+    The fields (Element-s or sequences of strings) to write.
+    An arbitrary number of fields can be combined using ``{...}``.
+
+\return Element to be used in an XDMF-file.
+*/
+inline Element Grid(
+    std::initializer_list<Element> args);
+
+/**
+Combine fields whose number is only known at runtime to a single grid.
+The fields are moved (no deep copies), for example::
+
+    std::vector<Element> fields;
+    fields.push_back(Geometry(file, "/coor"));
+    ...
+    Grid("mesh", std::move(fields));
+
+\param name Name of the grid.
+\param args The fields (Element-s or sequences of strings) to write.
+\return Element to be used in an XDMF-file.
+*/
+inline Element Grid(
+    const std::string& name,
+    std::vector<Element>&& args);
+
+/**
+Combine a range of fields to a single grid.
+The fields are copied, unless ``std::make_move_iterator`` is used.
+
+\param name Name of the grid.
+\param first Iterator to the first field.
+\param last Iterator past the last field.
+\return Element to be used in an XDMF-file.
+*/
+template <class Iterator>
+inline Element Grid(
+    const std::string& name,
+    Iterator first,
+    Iterator last);
+
+/**
+Assemble a Grid() field by field, for example::
+
+    GridBuilder grid("mesh");
+    grid.add(Geometry(file, "/coor")).add(Topology(file, "/conn", ElementType::Quadrilateral));
+
+    for (auto& name : names) {
+        grid.add(Attribute(file, name, AttributeCenter::Cell));
+    }
+
+    xdmf = grid.get();
+
+The fields can also be handed (without copying) to TimeSeries::push_back()
+using release().
+*/
+class GridBuilder
+{
+public:
+
+    /**
+    Constructor.
+    An overload is available to specify the name of the grid.
+    */
+    GridBuilder() = default;
+
+    /**
+    Constructor, allowing a custom name of the grid.
+
+    \param name Name of the grid.
+    */
+    GridBuilder(const std::string& name);
+
+    /**
+    Add a field.
+
+    \param arg The field (Element or sequence of strings).
+    \return Reference to this builder.
+    */
+    inline GridBuilder& add(const Element& arg);
+
+    /**
+    Add a field (without copying it).
+
+    \param arg The field (Element or sequence of strings).
+    \return Reference to this builder.
+    */
+    inline GridBuilder& add(Element&& arg);
+
+    /**
+    Reserve storage for a number of fields.
+
+    \param n Number of fields.
+    */
+    inline void reserve(size_t n);
+
+    /**
+    Number of fields.
+
+    \return Number of fields.
+    */
+    inline size_t size() const;
+
+    /**
+    Get the grid, see Grid().
+
+    \return Element to be used in an XDMF-file.
+    */
+    inline Element get() const;
+
+    /**
+    Move the fields out of the builder, for example to
+    ``TimeSeries::push_back(time, grid.release())``.
+    The builder is empty afterwards.
+
+    \return The fields.
+    */
+    inline std::vector<Element> release();
+
+private:
+    std::vector<Element> m_data;
+    std::string m_name = "Grid";
+};
+
+/**
+Subset of the cells of a grid (e.g. a region of interest), without duplicating its
+Geometry() and Topology(): only the indices of the cells are stored.
+Attributes can be added that are defined on the subset
+(a cell-centered Attribute() has one item per index).
+A Subset can be used as an increment of a TimeSeries (see Increment()), for example::
+
+    series.push_back(time, {Increment(Subset(file, "/crack", "mesh", "crack", {...}))});
+
+\param file An open and readable HighFive file.
+\param dataset Path to the DataSet with the indices of the cells.
+\param target
+    Name of the grid of which to take a subset (see Grid()),
+    or an XPath to it (if it starts with ``/``).
+\param name Name of the subset.
+\param args The fields (Element-s or sequences of strings) defined on the subset.
+\return Element to be used in an XDMF-file.
+*/
+inline Element Subset(
+    const HighFive::File& file,
+    const std::string& dataset,
+    const std::string& target,
+    const std::string& name,
+    std::initializer_list<Element> args = {});
+
+/**
+Subset of the cells of a grid, using cached metadata.
+
+\param cache Metadata of the file (see MetadataCache).
+\param dataset Path to the DataSet with the indices of the cells.
+\param target Name of, or XPath to, the grid of which to take a subset.
+\param name Name of the subset.
+\param args The fields (Element-s or sequences of strings) defined on the subset.
+\return Element to be used in an XDMF-file.
+*/
+inline Element Subset(
+    MetadataCache& cache,
+    const std::string& dataset,
+    const std::string& target,
+    const std::string& name,
+    std::initializer_list<Element> args = {});
+
+/**
+Subset of the cells of a grid, from the metadata of the indices.
+
+\param index Metadata of the DataSet with the indices of the cells.
+\param target Name of, or XPath to, the grid of which to take a subset.
+\param name Name of the subset.
+\param args The fields (Element-s or sequences of strings) defined on the subset.
+\return Element to be used in an XDMF-file.
+*/
+inline Element Subset(
+    const Metadata& index,
+    const std::string& target,
+    const std::string& name,
+    std::initializer_list<Element> args = {});
+
+/**
+Combine partitions of a mesh (e.g. one per MPI-rank), each a grid of fields,
+to one spatial collection.
+Partitions can be inserted concurrently (e.g. from different threads),
+or gathered from all MPI-ranks using gather().
+A SpatialCollection can be used as an increment of a TimeSeries (see Increment()), for example::
+
+    SpatialCollection partitions;
+    partitions.insert(rank, {Unstructured(...), Attribute(...)});
+    ...
+    series.push_back(time, {Increment(partitions.get())});
+
+Note that the fields of a partition can be composed without HDF5 I/O,
+see e.g. Geometry(const std::string&, const std::string&, const std::vector<size_t>&).
+*/
+class SpatialCollection
+{
+public:
+
+    /**
+    Constructor.
+    An overload is available to specify the name of the SpatialCollection.
+    */
+    SpatialCollection() = default;
+
+    /**
+    Constructor, allowing a custom name of the SpatialCollection.
+    The partitions are named ``name + "_" + rank``.
+
+    \param name Name of the SpatialCollection.
+    */
+    SpatialCollection(const std::string& name);
+
+    /**
+    Add a partition (thread-safe).
+
+    \param rank Index of the partition (determines the order in the XDMF-file).
+    \param args The fields (Element-s or sequences of strings) of the partition.
+    * An arbitrary number of fields can be combined using {...}.
+    */
+    inline void insert(size_t rank, std::initializer_list<Element> args);
+
+    /**
+    Number of partitions.
+
+    \return Number of partitions.
+    */
+    inline size_t size() const;
+
+    /**
+    Get the spatial collection.
+
+    \return Element to be used in an XDMF-file.
+    */
+    inline Element get() const;
+
+#ifdef XDMFWRITE_HIGHFIVE_USE_MPI
+    /**
+    Gather the partitions of all ranks on one rank.
+    Must be called by all ranks of the communicator.
+    Throws (on all ranks) if the partitions together are too large to be sent in one MPI call
+    (more than ``INT_MAX`` characters).
+
+    \param comm MPI communicator.
+    \param root Rank that receives all partitions.
+    */
+    inline void gather(MPI_Comm comm, int root = 0);
+#endif
+
+private:
+    mutable std::mutex m_mutex;
+    std::map<size_t, Element> m_data;
+    std::string m_name = "SpatialCollection";
+};
+
+/**
+Use a collection (e.g. SpatialCollection::get()) or a Subset() as increment of a TimeSeries,
+StreamingTimeSeries, or ConcurrentTimeSeries, instead of as a field of the increment.
+It has to be the only field of the increment, and no shared fields can be set.
+For example::
+
+    series.push_back(time, {Increment(partitions.get())});
+
+\param grid The collection or Subset.
+\return Element to be passed to push_back().
+*/
+inline Element Increment(const Element& grid);
+
+/**
+\cond
+*/
+namespace detail {
+    struct access;
+
+    // Storage of unique strings, referred to by an ID.
+    // Each string is stored once (the index refers to the stored strings).
+    class string_pool
+    {
+    public:
+        string_pool() = default;
+        string_pool(string_pool&&) = default;
+        string_pool& operator=(string_pool&&) = default;
+
+        string_pool(const string_pool& other)
+        {
+            for (auto& str : other.m_strings) {
+                this->intern(str);
+            }
+        }
+
+        string_pool& operator=(const string_pool& other)
+        {
+            if (this != &other) {
+                m_index.clear();
+                m_strings.clear();
+                for (auto& str : other.m_strings) {
+                    this->intern(str);
+                }
+            }
+            return *this;
+        }
+
+        uint32_t intern(const std::string& str)
+        {
+            auto it = m_index.find(&str);
+            if (it != m_index.end()) {
+                return it->second;
+            }
+            uint32_t id = static_cast<uint32_t>(m_strings.size());
+            m_strings.push_back(str);
+            m_index.emplace(&m_strings.back(), id);
+            return id;
+        }
+
+        const std::string& operator[](uint32_t id) const
+        {
+            return m_strings[id];
+        }
+
+        size_t size() const
+        {
+            return m_strings.size();
+        }
+
+    private:
+        struct hash
+        {
+            size_t operator()(const std::string* str) const
+            {
+                return std::hash<std::string>()(*str);
+            }
+        };
+
+        struct equal
+        {
+            bool operator()(const std::string* a, const std::string* b) const
+            {
+                return *a == *b;
+            }
+        };
+
+        std::deque<std::string> m_strings; // addresses are stable on push_back
+        std::unordered_map<const std::string*, uint32_t, hash, equal> m_index;
+    };
+
+    // Identity of an object that changes on each construction, copy, move, and assignment,
+    // such that an object can be recognised as being only appended to (in place).
+    class generation
+    {
+    public:
+        generation() : m_id(next())
+        {
+        }
+
+        generation(const generation&) : m_id(next())
+        {
+        }
+
+        generation(generation&& other) : m_id(next())
+        {
+            other.m_id = next();
+        }
+
+        generation& operator=(const generation&)
+        {
+            m_id = next();
+            return *this;
+        }
+
+        generation& operator=(generation&& other)
+        {
+            m_id = next();
+            other.m_id = next();
+            return *this;
+        }
+
+        size_t id() const
+        {
+            return m_id;
+        }
+
+    private:
+        static size_t next()
+        {
+            static std::atomic<size_t> counter(0);
+            return ++counter;
+        }
+
+        size_t m_id;
+    };
+
+    // Index of the calling thread: threads are numbered in the order in which they first call this
+    // function, such that (up to the number of shards) each thread has its own shard.
+    inline size_t thread_slot()
+    {
+        static std::atomic<size_t> counter(0);
+        thread_local size_t slot = counter++;
+        return slot;
+    }
+
+        // Increments of ConcurrentTimeSeries added by one (or a few) threads.
+    struct concurrent_shard
+    {
+        struct record
+        {
+            size_t step; // to sort the increments (first)
+            double time; // to sort the increments (second)
+            size_t sequence; // to sort the increments (last): order in which they were added
+            uint32_t time_str; // ID of the time value as written
+            uint32_t name; // ID of the name of the increment (empty: determined on output)
+            size_t offset; // position of the encoded fields in "data"
+            size_t n; // number of fields
+        };
+
+        std::mutex mutex;
+        string_pool strings;
+        std::vector<uint32_t> data;
+        std::vector<record> records;
+    };
+}
+/**
+\endcond
+*/
+
+/**
+Combine a series of fields (e.g. Geometry(), Topology(), and Attribute) to a time-series.
+The increments are stored compactly: all strings (tags, attributes, filenames, paths, ...)
+are stored once, and each increment is a sequence of IDs to them.
+The XML is only generated by get() or write().
+*/
+class TimeSeries
+{
+public:
+
+    /**
+    Constructor.
+    An overload is available to specify the name of the TimeSeries.
+    */
+    TimeSeries() = default;
+
+    /**
+    Constructor, allowing a custom name of the TimeSeries.
+
+    \param name Name of the TimeSeries.
+    */
+    TimeSeries(const std::string& name);
+
+    /**
+    Add a time-step given by a combination of fields (e.g. Geometry(), Topology(), and Attribute()).
+
+    \param name Name of the increment.
+    \param time Time value of the increment.
+    \param args The fields (Element-s or sequences of strings) to write.
+    * An arbitrary number of fields can be combined using {...}.
+    */
+    template <class T>
+    inline void push_back(
+        const std::string& name,
+        const T& time,
+        std::initializer_list<Element> args);
+
+    /**
+    Add a time-step given by fields whose number is only known at runtime.
+    The fields are moved (no deep copies).
+
+    \param name Name of the increment.
+    \param time Time value of the increment.
+    \param args The fields (Element-s or sequences of strings) to write.
+    */
+    template <class T>
+    inline void push_back(
+        const std::string& name,
+        const T& time,
+        std::vector<Element>&& args);
+
+    /**
+    Add a time-step given by a combination of fields (e.g. Geometry(), Topology(), and Attribute()).
+    An overload is available to specify the time and name of the increment.
+
+    \param time
+        Time value of the increment.
+
+    \param args
+        The fields (Element-s or sequences of strings) to write.
+        An arbitrary number of fields can be combined using ``{...}``.
+    */
+    template <class T>
+    inline void push_back(
+        const T& time,
+        std::initializer_list<Element> args);
+
+    /**
+    Add a time-step given by fields whose number is only known at runtime.
+    The fields are moved (no deep copies).
+
+    \param time Time value of the increment.
+    \param args The fields (Element-s or sequences of strings) to write.
+    */
+    template <class T>
+    inline void push_back(
+        const T& time,
+        std::vector<Element>&& args);
+
+    /**
+    Add a time-step given by a combination of fields (e.g. Geometry(), Topology(), and Attribute()).
+    An overload is available to specify the time and name of the increment.
+
+    \param args
+        The fields (Element-s or sequences of strings) to write.
+        An arbitrary number of fields can be combined using ``{...}``.
+
+    \return
+        Sequence of strings to be used in an XDMF-file.
+    */
+    inline void push_back(
+        std::initializer_list<Element> args);
+
+    /**
+    Add a time-step given by fields whose number is only known at runtime.
+    The fields are moved (no deep copies).
+
+    \param args The fields (Element-s or sequences of strings) to write.
+    */
+    inline void push_back(
+        std::vector<Element>&& args);
+
+    /**
+    Set fields that are the same for all increments (e.g. Geometry() and Topology() of a fixed mesh).
+    They are written in full in the first increment only.
+    All other increments include them by reference (using XInclude),
+    such that per increment only the fields specified to push_back() are written.
+    This function has to be called before the first push_back().
+
+    \param args
+        The fields (Element-s or sequences of strings) to write.
+        An arbitrary number of fields can be combined using ``{...}``.
+    */
+    inline void set_shared(std::initializer_list<Element> args);
+
+    /**
+    Get sequence of strings to be used in an XDMF-file.
+
+    \return Sequence of strings to be used in an XDMF-file.
+    */
+    inline std::vector<std::string> get() const;
+
+private:
+    template <class S>
+    inline void render(S& sink, size_t depth) const;
+
+    friend struct detail::access;
+
+private:
+    detail::string_pool m_strings; // unique strings of all increments
+    std::vector<uint32_t> m_data; // increments, encoded using detail::encode()
+    Element m_shared;
+    Element m_reference;
+    std::string m_name = "TimeSeries";
+    size_t m_n = 0;
+    detail::generation m_generation; // see AsyncWriter
+};
+
+/**
+Build a TimeSeries from the layout of a file in which each field is stored per increment,
+e.g.::
+
+    /coor
+    /conn
+    /disp/0
+    /disp/1
+    ...
+    /stress/0
+    /stress/1
+    ...
+
+The file is traversed once (see MetadataCache::prefetch()).
+Each DataSet whose path matches ``pattern`` is added as an Attribute() to an increment:
+the first group of ``pattern`` is the name of the field, the second the increment.
+An Attribute() is node-centered if its number of items is the number of nodes,
+or cell-centered if it is the number of elements (DataSets that are neither are skipped).
+If the number of nodes and elements are the same, the center of each field has to be specified
+in ``centers`` (an exception is thrown otherwise).
+The mesh is shared by all increments (see TimeSeries::set_shared()).
+
+\param file An open and readable HighFive file.
+\param dataset_geometry Path to the Geometry() DataSet.
+\param dataset_topology Path to the Topology() DataSet.
+\param type ElementType() (or GooseFEM's ElementType).
+\param pattern Regular expression with two groups: the name of the field, and the increment.
+\param dataset_time Path to a DataSet with the time of each increment (default: the increment).
+\param centers Center of (some of) the fields, by name (default: from the number of items).
+\return TimeSeries.
+*/
+template <class T>
+inline TimeSeries Discover(
+    const HighFive::File& file,
+    const std::string& dataset_geometry,
+    const std::string& dataset_topology,
+    const T& type,
+    const std::string& pattern = "/(\\w+)/(\\d+)",
+    const std::string& dataset_time = "",
+    const std::map<std::string, AttributeCenter>& centers = {});
+
+/**
+Build a TimeSeries from the layout of a file, using cached metadata.
+Only cached DataSets are considered: use MetadataCache::prefetch() to cache all DataSets.
+
+\param cache Metadata of the file (see MetadataCache).
+\param dataset_geometry Path to the Geometry() DataSet.
+\param dataset_topology Path to the Topology() DataSet.
+\param type ElementType() (or GooseFEM's ElementType).
+\param pattern Regular expression with two groups: the name of the field, and the increment.
+\param dataset_time Path to a DataSet with the time of each increment (default: the increment).
+\param centers Center of (some of) the fields, by name (default: from the number of items).
+\return TimeSeries.
+*/
+template <class T>
+inline TimeSeries Discover(
+    MetadataCache& cache,
+    const std::string& dataset_geometry,
+    const std::string& dataset_topology,
+    const T& type,
+    const std::string& pattern = "/(\\w+)/(\\d+)",
+    const std::string& dataset_time = "",
+    const std::map<std::string, AttributeCenter>& centers = {});
+
+/**
+Build a TimeSeries from the layout of a file, using cached metadata and given time values.
+This does not do any HDF5 I/O if the Geometry() and Topology() DataSets are cached
+(and no other DataSets are considered than those cached).
+
+\param cache Metadata of the file (see MetadataCache).
+\param dataset_geometry Path to the Geometry() DataSet.
+\param dataset_topology Path to the Topology() DataSet.
+\param type ElementType() (or GooseFEM's ElementType).
+\param pattern Regular expression with two groups: the name of the field, and the increment.
+\param time Time of each increment (if empty: the increment).
+\param centers Center of (some of) the fields, by name (default: from the number of items).
+\return TimeSeries.
+*/
+template <class T>
+inline TimeSeries Discover(
+    MetadataCache& cache,
+    const std::string& dataset_geometry,
+    const std::string& dataset_topology,
+    const T& type,
+    const std::string& pattern,
+    const std::vector<double>& time,
+    const std::map<std::string, AttributeCenter>& centers = {});
+
+/**
+Resume a TimeSeries from an XDMF-file written by this library (using TimeSeries or
+StreamingTimeSeries), e.g. after a restart, such that push_back() continues where it stopped.
+The XDMF-file is parsed, the HDF5-file is not accessed.
+The fields shared by all increments (see TimeSeries::set_shared()) are resumed as well.
+They follow from the reference to them in the second increment.
+If the file has only one increment, there is no such reference:
+no fields are taken to be shared, i.e. the fields of each further increment have to be
+passed to push_back() in full.
+
+\param filename The XDMF-file.
+\return TimeSeries.
+*/
+inline TimeSeries Resume(const std::string& filename);
+
+/**
+Resume a TimeSeries from an XDMF-file, removing the last increments of which not all DataSets
+exist (e.g. because they were not written before a crash).
+Only DataSets in ``file`` are checked, i.e. DataItem-s whose filename has the same basename as
+``file`` (such that e.g. ``"tmp.h5"``, ``"./tmp.h5"``, and ``"/path/to/tmp.h5"`` match).
+
+\param filename The XDMF-file.
+\param file An open and readable HighFive file.
+\return TimeSeries.
+*/
+inline TimeSeries Resume(const std::string& filename, const HighFive::File& file);
+
+/**
+Combine a series of fields to a time-series, adding increments concurrently from many threads.
+Increments may be added in any order: they are written sorted by time
+(increments with the same time in the order in which they were added),
+or sorted by step index if added using insert().
+The time therefore has to be numeric (unlike for TimeSeries, a string is not accepted).
+Unnamed increments are named "Increment i" according to that order.
+
+Each thread adds its increments to one of a number of shards, each with its own lock.
+Threads are assigned to shards in turn (in the order in which they first add an increment),
+such that threads only share a lock if there are more threads than shards.
+Like in TimeSeries, the increments are stored compactly.
+The XML is only generated by get() or write() (which should not be called concurrently with
+push_back()).
+*/
+class ConcurrentTimeSeries
+{
+public:
+
+    /**
+    Constructor.
+    An overload is available to specify the name of the TimeSeries and the number of shards.
+    */
+    ConcurrentTimeSeries();
+
+    /**
+    Constructor, allowing a custom name of the TimeSeries and number of shards.
+
+    \param name Name of the TimeSeries.
+    \param shards Number of shards (default: number of hardware threads).
+    */
+    ConcurrentTimeSeries(const std::string& name, size_t shards = 0);
+
+    /**
+    Add a time-step given by a combination of fields (thread-safe).
+
+    \param name Name of the increment.
+    \param time Time value of the increment.
+    \param args The fields (Element-s or sequences of strings) to write.
+    * An arbitrary number of fields can be combined using {...}.
+    */
+    template <class T>
+    inline void push_back(
+        const std::string& name,
+        const T& time,
+        std::initializer_list<Element> args);
+
+    /**
+    Add a time-step given by fields whose number is only known at runtime (thread-safe).
+
+    \param name Name of the increment.
+    \param time Time value of the increment.
+    \param args The fields (Element-s or sequences of strings) to write.
+    */
+    template <class T>
+    inline void push_back(
+        const std::string& name,
+        const T& time,
+        std::vector<Element>&& args);
+
+    /**
+    Add a time-step given by a combination of fields (thread-safe).
+    An overload is available to specify the name of the increment.
+
+    \param time Time value of the increment.
+    \param args The fields (Element-s or sequences of strings) to write.
+    * An arbitrary number of fields can be combined using {...}.
+    */
+    template <class T>
+    inline void push_back(
+        const T& time,
+        std::initializer_list<Element> args);
+
+    /**
+    Add a time-step given by fields whose number is only known at runtime (thread-safe).
+
+    \param time Time value of the increment.
+    \param args The fields (Element-s or sequences of strings) to write.
+    */
+    template <class T>
+    inline void push_back(
+        const T& time,
+        std::vector<Element>&& args);
+
+    /**
+    Add a time-step with a given step index (thread-safe).
+    Increments are written sorted by step index, then by time.
+    Increments added by push_back() have step index 0 (i.e. they are sorted by time only).
+
+    \param step Step index of the increment.
+    \param time Time value of the increment.
+    \param args The fields (Element-s or sequences of strings) to write.
+    * An arbitrary number of fields can be combined using {...}.
+    */
+    template <class T>
+    inline void insert(
+        size_t step,
+        const T& time,
+        std::initializer_list<Element> args);
+
+    /**
+    Add a time-step with a given step index, given by fields whose number is only known at
+    runtime (thread-safe).
+
+    \param step Step index of the increment.
+    \param time Time value of the increment.
+    \param args The fields (Element-s or sequences of strings) to write.
+    */
+    template <class T>
+    inline void insert(
+        size_t step,
+        const T& time,
+        std::vector<Element>&& args);
+
+    /**
+    Set fields that are the same for all increments (see TimeSeries::set_shared()).
+    This function has to be called before the first push_back().
+
+    \param args The fields (Element-s or sequences of strings) to write.
+    */
+    inline void set_shared(std::initializer_list<Element> args);
+
+    /**
+    Number of increments.
+
+    \return Number of increments.
+    */
+    inline size_t size() const;
+
+    /**
+    Get sequence of strings to be used in an XDMF-file.
+
+    \return Sequence of strings to be used in an XDMF-file.
+    */
+    inline std::vector<std::string> get() const;
+
+private:
+    template <class T>
+    inline void add(
+        size_t step,
+        const std::string& name,
+        const T& time,
+        std::vector<Element>&& args);
+
+    template <class S>
+    inline void render(S& sink, size_t depth) const;
+
+    friend struct detail::access;
+
+private:
+    std::vector<std::unique_ptr<detail::concurrent_shard>> m_shards;
+    std::unique_ptr<std::atomic<size_t>> m_sequence; // number of increments added (movable)
+    Element m_shared;
+    Element m_reference;
+    std::string m_name = "TimeSeries";
+};
+
+/**
+Write a time-series directly to an XDMF-file, increment by increment.
+The syntax is identical to that of TimeSeries, but instead of keeping all increments in memory,
+each increment is written to the file as soon as it is added.
+The file is kept open: a new increment overwrites the closing tags of the document,
+which are then written again.
+Each push_back() therefore costs the same, independent of the number of increments,
+and the file on disk is a complete XDMF-file after each push_back().
+*/
+class StreamingTimeSeries
+{
+public:
+
+    /**
+    Constructor.
+    An overload is available to specify the name of the TimeSeries.
+
+    \param filename The filename to write to (file is overwritten).
+    */
+    StreamingTimeSeries(const std::string& filename);
+
+    /**
+    Constructor, allowing a custom name of the TimeSeries.
+
+    \param filename The filename to write to (file is overwritten).
+    \param name Name of the TimeSeries.
+    */
+    StreamingTimeSeries(const std::string& filename, const std::string& name);
+
+    /**
+    Add a time-step given by a combination of fields (e.g. Geometry(), Topology(), and Attribute()),
+    and write it to the file.
+
+    \param name Name of the increment.
+    \param time Time value of the increment.
+    \param args The fields (Element-s or sequences of strings) to write.
+    * An arbitrary number of fields can be combined using {...}.
+    */
+    template <class T>
+    inline void push_back(
+        const std::string& name,
+        const T& time,
+        std::initializer_list<Element> args);
+
+    /**
+    Add a time-step given by fields whose number is only known at runtime.
+    The fields are moved (no deep copies).
+
+    \param name Name of the increment.
+    \param time Time value of the increment.
+    \param args The fields (Element-s or sequences of strings) to write.
+    */
+    template <class T>
+    inline void push_back(
+        const std::string& name,
+        const T& time,
+        std::vector<Element>&& args);
+
+    /**
+    Add a time-step given by a combination of fields (e.g. Geometry(), Topology(), and Attribute()),
+    and write it to the file.
+    An overload is available to specify the time and name of the increment.
+
+    \param time
+        Time value of the increment.
+
+    \param args
+        The fields (Element-s or sequences of strings) to write.
+        An arbitrary number of fields can be combined using ``{...}``.
+    */
+    template <class T>
+    inline void push_back(
+        const T& time,
+        std::initializer_list<Element> args);
+
+    /**
+    Add a time-step given by fields whose number is only known at runtime.
+    The fields are moved (no deep copies).
+
+    \param time Time value of the increment.
+    \param args The fields (Element-s or sequences of strings) to write.
+    */
+    template <class T>
+    inline void push_back(
+        const T& time,
+        std::vector<Element>&& args);
+
+    /**
+    Add a time-step given by a combination of fields (e.g. Geometry(), Topology(), and Attribute()),
+    and write it to the file.
+    An overload is available to specify the time and name of the increment.
+
+    \param args
+        The fields (Element-s or sequences of strings) to write.
+        An arbitrary number of fields can be combined using ``{...}``.
+    */
+    inline void push_back(
+        std::initializer_list<Element> args);
+
+    /**
+    Add a time-step given by fields whose number is only known at runtime.
+    The fields are moved (no deep copies).
+
+    \param args The fields (Element-s or sequences of strings) to write.
+    */
+    inline void push_back(
+        std::vector<Element>&& args);
+
+    /**
+    Set fields that are the same for all increments (e.g. Geometry() and Topology() of a fixed mesh).
+    They are written in full in the first increment only.
+    All other increments include them by reference (using XInclude),
+    such that per increment only the fields specified to push_back() are written.
+    This function has to be called before the first push_back().
+
+    \param args
+        The fields (Element-s or sequences of strings) to write.
+        An arbitrary number of fields can be combined using ``{...}``.
+    */
+    inline void set_shared(std::initializer_list<Element> args);
+
+    /**
+    Close the file.
+    This is done automatically on destruction.
+    */
+    inline void close();
+
+private:
+    inline void write_tail();
+
+private:
+    std::ofstream m_file;
+    std::streampos m_tail; // position in the file at which the closing tags start
+    Element m_shared;
+    Element m_reference;
+    std::string m_name = "TimeSeries";
+    size_t m_n = 0;
+};
+
+/**
+Interpret a DataSet as a Structured (individual points). This is simply short for the
+concatenation of:
+
+-   ``Geometry(file, "/coor")`` and
+-   ``Topology(ElementType::Polyvertex, N)``, with N the number of nodes (vertices).
+
+No Topology() DataSet is needed.
+
+\param file An open and readable HighFive file.
+\param dataset_geometry Path to the Geometry() DataSet.
+\return Element to be used in an XDMF-file.
+*/
+inline Element Structured(
+    const HighFive::File& file,
+    const std::string& dataset_geometry);
+
+/**
+Interpret a DataSet as a Structured (individual points), using cached metadata.
+No Topology() DataSet is needed.
+
+\param cache Metadata of the file (see MetadataCache).
+\param dataset_geometry Path to the Geometry() DataSet.
+\return Element to be used in an XDMF-file.
+*/
+inline Element Structured(
+    MetadataCache& cache,
+    const std::string& dataset_geometry);
+
+/**
+Interpret a DataSet as a Structured (individual points), from its metadata.
+No Topology() DataSet is needed.
+
+\param geometry Metadata of the Geometry() DataSet.
+\return Element to be used in an XDMF-file.
+*/
+inline Element Structured(
+    const Metadata& geometry);
+
+/**
+Interpret a DataSets as a Structured (individual points), using a mock Topology() DataSet.
+This is simply short for the concatenation of:
+
+-   ``Geometry(file, "/coor")`` and
+-   ``Topology(file, "/conn", ElementType::Polyvertex)``.
+
+Use the overload without ``dataset_topology`` to omit the mock Topology() DataSet.
+
+\param file An open and readable HighFive file.
+\param dataset_geometry Path to the Geometry() DataSet.
+\param dataset_topology Path to a mock Topology() arange(N), with N the number of nodes (vertices).
+\return Element to be used in an XDMF-file.
+*/
+inline Element Structured(
+    const HighFive::File& file,
+    const std::string& dataset_geometry,
+    const std::string& dataset_topology);
+
+/**
+Interpret a DataSets as a Structured (individual points), using cached metadata.
+
+\param cache Metadata of the file (see MetadataCache).
+\param dataset_geometry Path to the Geometry() DataSet.
+\param dataset_topology Path to a mock Topology() arange(N), with N the number of nodes (vertices).
+\return Element to be used in an XDMF-file.
+*/
+inline Element Structured(
+    MetadataCache& cache,
+    const std::string& dataset_geometry,
+    const std::string& dataset_topology);
+
+/**
+Interpret part of a DataSet as a Structured (individual points),
+e.g. the points of one increment of a RaggedField.
+The Polyvertex Topology() is written without DataSet.
+
+\param geometry Selection of the Geometry() DataSet (see HyperSlab).
+\return Element to be used in an XDMF-file.
+*/
+inline Element Structured(
+    const HyperSlab& geometry);
+
+/**
+Interpret a DataSets as a Unstructured
+(Geometry() and Topology() / nodal-coordinates and connectivity). This is simply short for the
+concatenation of
+-   ``Geometry(file, "/coor")`` and
+-   ``Topology(file, "/conn", type)``.
+
+\param file An open and readable HighFive file.
+\param dataset_geometry Path to the Geometry() DataSet.
+\param dataset_topology Path to the Topology() DataSet.
+\param type Element-type (see ElementType()).
+\return Element to be used in an XDMF-file.
+*/
+template <class T>
+inline Element Unstructured(
+    const HighFive::File& file,
+    const std::string& dataset_geometry,
+    const std::string& dataset_topology,
+    const T& type);
+
+/**
+Interpret a DataSets as a Unstructured, using cached metadata.
+
+\param cache Metadata of the file (see MetadataCache).
+\param dataset_geometry Path to the Geometry() DataSet.
+\param dataset_topology Path to the Topology() DataSet.
+\param type Element-type (see ElementType()).
+\return Element to be used in an XDMF-file.
+*/
+template <class T>
+inline Element Unstructured(
+    MetadataCache& cache,
+    const std::string& dataset_geometry,
+    const std::string& dataset_topology,
+    const T& type);
+
+/**
+Regular grid (equal spacing along each axis) without any DataSet.
+This writes a ``2DCoRectMesh`` or ``3DCoRectMesh`` Topology() with an ``ORIGIN_DXDY``
+or ``ORIGIN_DXDYDZ`` Geometry().
+
+All arguments are in the order of the axes of the nodal data in C-order,
+i.e. ``{ny, nx}`` in 2-d and ``{nz, ny, nx}`` in 3-d.
+Attributes are stored per node (or cell) in the same order, e.g. as ``[nz * ny * nx]``.
+
+\param shape Number of nodes along each axis.
+\param origin Coordinates of the first node.
+\param spacing Distance between two nodes along each axis.
+\return Element to be used in an XDMF-file.
+*/
+inline Element RegularGrid(
+    const std::vector<size_t>& shape,
+    const std::vector<double>& origin,
+    const std::vector<double>& spacing);
+
+/**
+Rectilinear grid (variable spacing along each axis), from the coordinates along each axis.
+This writes a ``2DRectMesh`` or ``3DRectMesh`` Topology() with a ``VXVY``
+or ``VXVYVZ`` Geometry().
+
+The axes are in the order of the axes of the nodal data in C-order,
+i.e. ``{"/y", "/x"}`` in 2-d and ``{"/z", "/y", "/x"}`` in 3-d.
+Attributes are stored per node (or cell) in the same order, e.g. as ``[nz * ny * nx]``.
+
+\param file An open and readable HighFive file.
+\param datasets Path to the (one-dimensional) DataSet with the coordinates along each axis.
+\return Element to be used in an XDMF-file.
+*/
+inline Element RectilinearGrid(
+    const HighFive::File& file,
+    const std::vector<std::string>& datasets);
+
+/**
+Rectilinear grid (variable spacing along each axis), using cached metadata.
+
+\param cache Metadata of the file (see MetadataCache).
+\param datasets Path to the (one-dimensional) DataSet with the coordinates along each axis.
+\return Element to be used in an XDMF-file.
+*/
+inline Element RectilinearGrid(
+    MetadataCache& cache,
+    const std::vector<std::string>& datasets);
+
+/**
+Rectilinear grid (variable spacing along each axis), from the metadata of the axes.
+
+\param axes Metadata of the DataSet with the coordinates along each axis.
+\return Element to be used in an XDMF-file.
+*/
+inline Element RectilinearGrid(
+    const std::vector<Metadata>& axes);
+
+/**
+Get a complete XDMF-file, e.g. from Grid() or TimeSeries().
+
+\param arg The data (any of the XDMFWrite_HighFive-classes or a sequence of strings) to write.
+\return XDMF-file as string.
+*/
+template <class T>
+inline std::string write(const T& arg);
+
+/**
+Write a complete XDMF-file, e.g. from Grid() or TimeSeries().
+The file is written line-by-line, without first constructing the XDMF-file in memory.
+
+\param filename The filename to write to (file is overwritten).
+\param arg The data (any of the XDMFWrite_HighFive-classes or a sequence of strings) to write.
+*/
+template <class T>
+inline void write(const std::string& filename, const T& arg);
+
+/**
+Write a complete XDMF-file to a stream, e.g. from Grid() or TimeSeries().
+The stream is written line-by-line, without first constructing the XDMF-file in memory.
+
+\param stream The stream to write to (e.g. ``std::cout`` or an ``std::ofstream``).
+\param arg The data (any of the XDMFWrite_HighFive-classes or a sequence of strings) to write.
+*/
+template <class T>
+inline void write(std::ostream& stream, const T& arg);
+
+/**
+\cond
+*/
+namespace detail {
+
+    // SFINAE helper: check if a template argument is an output iterator that accepts strings.
+    template <class It, typename = void>
+    struct is_string_output_iterator : std::false_type
+    {
+    };
+
+    template <class It>
+    struct is_string_output_iterator<It, decltype(
+        *std::declval<It&>() = std::declval<std::string>(), ++std::declval<It&>(), void())>
+        : std::true_type
+    {
+    };
+
+}
+/**
+\endcond
+*/
+
+/**
+Write a complete XDMF-file to an output iterator, e.g. from Grid() or TimeSeries().
+Each line of the XDMF-file is assigned to the iterator as soon as it is constructed.
+For example::
+
+    std::vector<std::string> lines;
+    write(std::back_inserter(lines), grid);
+
+\param out Output iterator to which the lines (``std::string``) are written.
+\param arg The data (any of the XDMFWrite_HighFive-classes or a sequence of strings) to write.
+\return Output iterator to the element past the last line written.
+*/
+template <
+    class It,
+    class T,
+    typename = std::enable_if_t<detail::is_string_output_iterator<It>::value>>
+inline It write(It out, const T& arg);
+
+/**
+\cond
+*/
+namespace detail {
+
+    // Position in a TimeSeries up to which it was passed to AsyncWriter.
+    struct series_cursor
+    {
+        size_t generation = 0; // identity of the TimeSeries, see detail::generation
+        size_t strings = 0; // number of strings in the pool
+        size_t data = 0; // number of encoded IDs
+        size_t n = 0; // number of increments
+    };
+
+    // Part of a TimeSeries that was added since a series_cursor.
+    struct series_delta
+    {
+        std::unique_ptr<TimeSeries> base; // complete copy, if there was no (valid) cursor
+        std::vector<std::string> strings; // strings added to the pool
+        std::vector<uint32_t> data; // encoded increments added
+        size_t n = 0; // total number of increments
+    };
+}
+/**
+\endcond
+*/
+
+/**
+Write XDMF-files on a background thread, such that the caller (e.g. the time loop of a simulation)
+does not wait for the XDMF-file to be rendered and written.
+For example::
+
+    AsyncWriter writer;
+    TimeSeries series;
+
+    for (...) {
+        ...
+        series.push_back(...);
+        writer.write("output.xdmf", series); // a snapshot of "series" is written
+    }
+
+    writer.flush();
+
+-   write() takes a snapshot of its argument (by copying, or moving, it).
+    For a TimeSeries that is written to the same file again, only the increments added since
+    the previous write() are copied (the background thread keeps a copy of the TimeSeries).
+    A TimeSeries that was assigned to (or copied, or moved) since is copied completely.
+    Note that the file is still rendered in full each time:
+    see StreamingTimeSeries to only write the new increments.
+
+-   Requests for a filename that is still waiting to be written are coalesced:
+    only the latest snapshot is written.
+
+-   At most ``capacity`` files wait to be written.
+    If the queue is full, write() blocks until there is room (back-pressure).
+
+-   Each file is written to a temporary file ``filename + ".tmp"``
+    that then replaces ``filename`` (using ``std::rename``, or ``MoveFileEx`` on Windows),
+    such that a reader never sees a partially written file.
+
+Exceptions on the background thread are rethrown by the next call to write() or flush().
+After an exception, a TimeSeries is copied completely by the next write() to the same file
+(a waiting request for that file with only new increments is discarded).
+*/
+class AsyncWriter
+{
+public:
+
+    /**
+    Constructor: start the background thread.
+
+    \param capacity Maximum number of files waiting to be written.
+    */
+    AsyncWriter(size_t capacity = 4);
+
+    /**
+    Destructor: write all pending files, and stop the background thread.
+    */
+    ~AsyncWriter();
+
+    AsyncWriter(const AsyncWriter&) = delete;
+    AsyncWriter& operator=(const AsyncWriter&) = delete;
+
+    /**
+    Write a complete XDMF-file, see XDMFWrite_HighFive::write(), on the background thread.
+
+    \param filename The filename to write to (file is overwritten).
+    \param arg The data (any of the XDMFWrite_HighFive-classes or a sequence of strings) to write.
+    */
+    template <class T>
+    inline void write(const std::string& filename, T&& arg);
+
+    /**
+    Wait until all files passed to write() have been written.
+    */
+    inline void flush();
+
+    /**
+    Number of files that are waiting to be written, or being written.
+
+    \return Number of files.
+    */
+    inline size_t pending() const;
+
+private:
+    struct job
+    {
+        std::string filename;
+        std::function<void(std::ostream&)> render; // empty for a TimeSeries, see "delta"
+        const TimeSeries* source = nullptr; // TimeSeries, copied to "delta" by enqueue()
+        detail::series_delta delta;
+    };
+
+    template <class T>
+    inline job snapshot(const std::string& filename, T&& arg, std::false_type);
+
+    inline job snapshot(const std::string& filename, const TimeSeries& arg, std::true_type);
+
+    inline void enqueue(job&& item);
+    inline void run();
+    inline void rethrow();
+
+private:
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cond;
+    std::deque<job> m_queue;
+    std::map<std::string, detail::series_cursor> m_cursor; // last TimeSeries per file
+    std::map<std::string, TimeSeries> m_series; // copy of each TimeSeries (background thread)
+    size_t m_capacity;
+    bool m_busy = false;
+    bool m_stop = false;
+    std::exception_ptr m_error;
+    std::thread m_thread;
+};
+
+// --- Implementation ---
+
+namespace detail {
+
+    inline std::string unquote(const std::string& arg)
+    {
+        std::string ret = arg;
+        ret.erase(std::remove(ret.begin(), ret.end(), '\"'), ret.end());
+        return ret;
+    }
+
+}
+
+inline std::string version()
+{
+    return detail::unquote(std::string(QUOTE(XDMFWRITE_HIGHFIVE_VERSION)));
+}
+
+namespace detail {
+
+    // SFINAE helper: check if a template argument is a string
+    template <class T>
+    struct is_string : std::false_type
+    {
+    };
+
+    template <>
+    struct is_string<std::string> : std::true_type
+    {
+    };
+
+    // SFINAE helper: check if a template argument is an ElementType enum-class.
+    template <class T>
+    struct is_ElementType : std::false_type
+    {
+    };
+
+    template <>
+    struct is_ElementType<ElementType> : std::true_type
+    {
+    };
+
+    // SFINAE helper: check if a template argument is an AttributeCenter enum-class.
+    template <class T>
+    struct is_AttributeCenter : std::false_type
+    {
+    };
+
+    template <>
+    struct is_AttributeCenter<AttributeCenter> : std::true_type
+    {
+    };
+
+    // SFINAE helper: check if a template argument is an GooseFEM-ElementType enum-class.
+    #ifdef XDMFWRITE_HIGHFIVE_USE_GOOSEFEM
+    template <class T>
+    struct is_GooseFEM_ElementType : std::false_type
+    {
+    };
+
+    template <>
+    struct is_GooseFEM_ElementType<GooseFEM::Mesh::ElementType> : std::true_type
+    {
+    };
+    #endif
+
+    // Convert object to string
+    template <class T, typename = void>
+    struct to
+    {
+        static std::string str(const T& arg)
+        {
+            return std::to_string(arg);
+        }
+    };
+
+    template <class T>
+    struct to<T, typename std::enable_if_t<is_string<T>::value>>
+    {
+        static std::string str(const T& arg)
+        {
+            return arg;
+        }
+    };
+
+    template <class T>
+    struct to<T, typename std::enable_if_t<is_ElementType<T>::value>>
+    {
+        static std::string str(const T& arg)
+        {
+            if (arg == ElementType::Polyvertex) {
+                return "Polyvertex";
+            }
+            else if (arg == ElementType::Triangle) {
+                return "Triangle";
+            }
+            else if (arg == ElementType::Quadrilateral) {
+                return "Quadrilateral";
+            }
+            else if (arg == ElementType::Tetrahedron) {
+                return "Tetrahedron";
+            }
+            else if (arg == ElementType::Pyramid) {
+                return "Pyramid";
+            }
+            else if (arg == ElementType::Wedge) {
+                return "Wedge";
+            }
+            else if (arg == ElementType::Hexahedron) {
+                return "Hexahedron";
+            }
+            else if (arg == ElementType::Triangle_6) {
+                return "Triangle_6";
+            }
+            else if (arg == ElementType::Quadrilateral_8) {
+                return "Quadrilateral_8";
+            }
+            else if (arg == ElementType::Hexahedron_20) {
+                return "Hexahedron_20";
+            }
+            throw XDMFWRITE_HIGHFIVE_THROW("Unknown ElementType");
+        }
+
+        static ElementType type(const T& arg)
+        {
+            return arg;
+        }
+    };
+
+    #ifdef XDMFWRITE_HIGHFIVE_USE_GOOSEFEM
+    template <class T>
+    struct to<T, typename std::enable_if_t<is_GooseFEM_ElementType<T>::value>>
+    {
+        static std::string str(const T& arg)
+        {
+            if (arg == GooseFEM::Mesh::ElementType::Tri3) {
+                return "Triangle";
+            }
+            else if (arg == GooseFEM::Mesh::ElementType::Quad4) {
+                return "Quadrilateral";
+            }
+            else if (arg == GooseFEM::Mesh::ElementType::Hex8) {
+                return "Hexahedron";
+            }
+            throw XDMFWRITE_HIGHFIVE_THROW("Unknown ElementType");
+        }
+
+        static ElementType type(const T& arg)
+        {
+            if (arg == GooseFEM::Mesh::ElementType::Tri3) {
+                return ElementType::Triangle;
+            }
+            else if (arg == GooseFEM::Mesh::ElementType::Quad4) {
+                return ElementType::Quadrilateral;
+            }
+            else if (arg == GooseFEM::Mesh::ElementType::Hex8) {
+                return ElementType::Hexahedron;
+            }
+            throw XDMFWRITE_HIGHFIVE_THROW("Unknown ElementType");
+        }
+    };
+    #endif
+
+    template <class T>
+    struct to<T, typename std::enable_if_t<is_AttributeCenter<T>::value>>
+    {
+        static std::string str(const T& arg)
+        {
+            if (arg == AttributeCenter::Cell) {
+                return "Cell";
+            }
+            else if (arg == AttributeCenter::Node) {
+                return "Node";
+            }
+            throw XDMFWRITE_HIGHFIVE_THROW("Unknown AttributeType");
+        }
+    };
+
+    template <class T>
+    inline std::string join_as_string(const std::vector<T>& arg, std::string sep)
+    {
+        std::vector<std::string> ret;
+        for (auto& i : arg) {
+            ret.push_back(to<T>::str(i));
+        }
+        return join(ret, sep);
+    }
+
+    // Shortest of "digits10" and "max_digits10" digits that reads back to the same value
+    // (independent of the locale).
+    inline std::string round_trip(double arg)
+    {
+        std::ostringstream out;
+        out.imbue(std::locale::classic());
+        out << std::setprecision(std::numeric_limits<double>::digits10) << arg;
+
+        std::istringstream in(out.str());
+        in.imbue(std::locale::classic());
+        double check;
+        in >> check;
+
+        if (check == arg) {
+            return out.str();
+        }
+
+        out.str("");
+        out << std::setprecision(std::numeric_limits<double>::max_digits10) << arg;
+        return out.str();
+    }
+
+    // Number of nodes per element.
+    inline size_t nodes_per_element(ElementType type)
+    {
+        switch (type) {
+            case ElementType::Polyvertex: return 1;
+            case ElementType::Triangle: return 3;
+            case ElementType::Quadrilateral: return 4;
+            case ElementType::Tetrahedron: return 4;
+            case ElementType::Pyramid: return 5;
+            case ElementType::Wedge: return 6;
+            case ElementType::Hexahedron: return 8;
+            case ElementType::Triangle_6: return 6;
+            case ElementType::Quadrilateral_8: return 8;
+            case ElementType::Hexahedron_20: return 20;
+        }
+        throw XDMFWRITE_HIGHFIVE_THROW("Unknown ElementType");
+    }
+
+    // XDMF type code of an element in a Mixed Topology.
+    inline size_t type_code(ElementType type)
+    {
+        switch (type) {
+            case ElementType::Polyvertex: return 1;
+            case ElementType::Triangle: return 4;
+            case ElementType::Quadrilateral: return 5;
+            case ElementType::Tetrahedron: return 6;
+            case ElementType::Pyramid: return 7;
+            case ElementType::Wedge: return 8;
+            case ElementType::Hexahedron: return 9;
+            case ElementType::Triangle_6: return 36;
+            case ElementType::Quadrilateral_8: return 37;
+            case ElementType::Hexahedron_20: return 48;
+        }
+        throw XDMFWRITE_HIGHFIVE_THROW("Unknown ElementType");
+    }
+
+    template <class T, class E>
+    inline bool check_shape(const T& shape, E type)
+    {
+        auto t = detail::to<E>::type(type);
+
+        if (shape.size() == 1 && t == ElementType::Polyvertex) {
+            return true;
+        }
+        if (shape.size() != 2) {
+            return false;
+        }
+        return shape[1] == nodes_per_element(t);
+    }
+
+    inline std::string indent()
+    {
+        std::string ret = "";
+        if (XDMFWRITE_HIGHFIVE_INDENT == 0) {
+            return ret;
+        }
+        for (size_t i = 0; i < XDMFWRITE_HIGHFIVE_INDENT; ++i) {
+            ret += " ";
+        }
+        return ret;
+    }
+
+    inline std::string indent(size_t n)
+    {
+        std::string ret;
+        std::string i = indent();
+        for (size_t j = 0; j < n; ++j) {
+            ret += i;
+        }
+        return ret;
+    }
+
+    // Write a sequence of strings (one string per line).
+    class lines_sink
+    {
+    public:
+        lines_sink(std::vector<std::string>& lines) : m_lines(lines)
+        {
+        }
+
+        void begin(size_t depth)
+        {
+            m_line = indent(depth);
+        }
+
+        void append(const std::string& arg)
+        {
+            m_line += arg;
+        }
+
+        void end()
+        {
+            m_lines.push_back(m_line);
+        }
+
+    private:
+        std::vector<std::string>& m_lines;
+        std::string m_line;
+    };
+
+    // Write directly to a stream (each line ends with a newline).
+    class stream_sink
+    {
+    public:
+        stream_sink(std::ostream& stream) : m_stream(stream), m_indent(indent())
+        {
+        }
+
+        void begin(size_t depth)
+        {
+            for (size_t i = 0; i < depth; ++i) {
+                m_stream << m_indent;
+            }
+        }
+
+        void append(const std::string& arg)
+        {
+            m_stream << arg;
+        }
+
+        void end()
+        {
+            m_stream << '\n';
+        }
+
+    private:
+        std::ostream& m_stream;
+        std::string m_indent;
+    };
+
+    // Write to an output iterator (one string per line).
+    template <class It>
+    class iterator_sink
+    {
+    public:
+        iterator_sink(It out) : m_out(out)
+        {
+        }
+
+        void begin(size_t depth)
+        {
+            m_line = indent(depth);
+        }
+
+        void append(const std::string& arg)
+        {
+            m_line += arg;
+        }
+
+        void end()
+        {
+            *m_out = std::move(m_line);
+            ++m_out;
+        }
+
+        It out() const
+        {
+            return m_out;
+        }
+
+    private:
+        It m_out;
+        std::string m_line;
+    };
+
+    // Write the opening tag of an element (without closing the line).
+    template <class S>
+    inline void render_tag(S& sink, const Element& arg, size_t depth)
+    {
+        sink.begin(depth);
+        sink.append("<");
+        sink.append(arg.tag());
+        for (auto& attribute : arg.attributes()) {
+            sink.append(" ");
+            sink.append(attribute.first);
+            sink.append("=\"");
+            sink.append(attribute.second);
+            sink.append("\"");
+        }
+    }
+
+    // Write the opening tag of an element on a single line.
+    template <class S>
+    inline void render_open(S& sink, const Element& arg, size_t depth)
+    {
+        render_tag(sink, arg, depth);
+        sink.append(">");
+        sink.append(arg.text());
+        sink.end();
+    }
+
+    // Write the closing tag of an element on a single line.
+    template <class S>
+    inline void render_close(S& sink, const Element& arg, size_t depth)
+    {
+        sink.begin(depth);
+        sink.append("</");
+        sink.append(arg.tag());
+        sink.append(">");
+        sink.end();
+    }
+
+    template <class S>
+    inline void render(S& sink, const std::vector<std::string>& lines, size_t depth)
+    {
+        for (auto& line : lines) {
+            sink.begin(depth);
+            sink.append(line);
+            sink.end();
+        }
+    }
+
+    template <class S>
+    inline void render(S& sink, const Element& arg, size_t depth)
+    {
+        if (arg.tag().size() == 0) {
+            render(sink, arg.lines(), depth);
+            for (auto& child : arg.children()) {
+                render(sink, child, depth);
+            }
+            return;
+        }
+
+        if (arg.children().size() > 0) {
+            render_open(sink, arg, depth);
+            for (auto& child : arg.children()) {
+                render(sink, child, depth + 1);
+            }
+            render_close(sink, arg, depth);
+            return;
+        }
+
+        render_tag(sink, arg, depth);
+
+        if (arg.text().size() == 0) {
+            sink.append("/>");
+        }
+        else {
+            sink.append(">");
+            sink.append(arg.text());
+            sink.append("</");
+            sink.append(arg.tag());
+            sink.append(">");
+        }
+
+        sink.end();
+    }
+
+    // Access to the rendering of the XDMFWrite_HighFive-classes.
+    struct access
+    {
+        template <class S, class T>
+        static void render(S& sink, const T& arg, size_t depth)
+        {
+            arg.render(sink, depth);
+        }
+
+        // Set the content of a TimeSeries (from complete increments).
+        template <class T>
+        static void restore(
+            T& arg,
+            const std::string& name,
+            const Element& shared,
+            const Element& reference,
+            const std::vector<Element>& increments)
+        {
+            arg = T(name);
+            arg.m_shared = shared;
+            arg.m_reference = reference;
+            for (auto& increment : increments) {
+                encode(increment, arg.m_strings, arg.m_data);
+            }
+            arg.m_n = increments.size();
+        }
+
+        // Copy what was added to a TimeSeries since "cursor", and move "cursor" to its end.
+        // The TimeSeries is copied completely if it is not the same object as at "cursor"
+        // (constructed, copied, moved, or assigned since), or if it had no increments
+        // (the shared fields can still change).
+        static void diff(const TimeSeries& arg, series_cursor& cursor, series_delta& delta)
+        {
+            bool follows = cursor.generation == arg.m_generation.id() && cursor.n > 0 &&
+                           arg.m_n >= cursor.n;
+
+            if (!follows) {
+                delta.base.reset(new TimeSeries(arg));
+            }
+            else {
+                for (size_t i = cursor.strings; i < arg.m_strings.size(); ++i) {
+                    delta.strings.push_back(arg.m_strings[static_cast<uint32_t>(i)]);
+                }
+                delta.data.insert(delta.data.end(), arg.m_data.begin() + cursor.data, arg.m_data.end());
+            }
+
+            delta.n = arg.m_n;
+            cursor = series_cursor{arg.m_generation.id(), arg.m_strings.size(), arg.m_data.size(), arg.m_n};
+        }
+
+        // Append to a copy of a TimeSeries what was added to it.
+        // The new strings are interned in order, such that their IDs are the same as in the original.
+        static void apply(TimeSeries& arg, const series_delta& delta)
+        {
+            for (auto& str : delta.strings) {
+                arg.m_strings.intern(str);
+            }
+            arg.m_data.insert(arg.m_data.end(), delta.data.begin(), delta.data.end());
+            arg.m_n = delta.n;
+        }
+    };
+
+    template <class S>
+    inline void render(S& sink, const TimeSeries& arg, size_t depth)
+    {
+        access::render(sink, arg, depth);
+    }
+
+    template <class S>
+    inline void render(S& sink, const ConcurrentTimeSeries& arg, size_t depth)
+    {
+        access::render(sink, arg, depth);
+    }
+
+    // Encode an element as a sequence of string IDs (and counts):
+    // tag, #attributes, (name, value)..., text (two IDs, see below), #lines, line...,
+    // #children, child...
+    // The text is split at its last ":", such that the filename and the path of a DataItem
+    // are stored separately (and each filename only once).
+    inline void encode(const Element& arg, string_pool& pool, std::vector<uint32_t>& out)
+    {
+        out.push_back(pool.intern(arg.tag()));
+
+        out.push_back(static_cast<uint32_t>(arg.attributes().size()));
+        for (auto& attr : arg.attributes()) {
+            out.push_back(pool.intern(attr.first));
+            out.push_back(pool.intern(attr.second));
+        }
+
+        const std::string& text = arg.text();
+        size_t i = text.rfind(':');
+        i = i == std::string::npos ? 0 : i + 1;
+        out.push_back(pool.intern(text.substr(0, i)));
+        out.push_back(pool.intern(text.substr(i)));
+
+        out.push_back(static_cast<uint32_t>(arg.lines().size()));
+        for (auto& line : arg.lines()) {
+            out.push_back(pool.intern(line));
+        }
+
+        out.push_back(static_cast<uint32_t>(arg.children().size()));
+        for (auto& child : arg.children()) {
+            encode(child, pool, out);
+        }
+    }
+
+    // Inverse of encode(), starting at "data[i]" (on output: the first item after the element).
+    inline Element decode(const std::vector<uint32_t>& data, size_t& i, const string_pool& pool)
+    {
+        std::string tag = pool[data[i++]];
+
+        std::vector<std::pair<std::string, std::string>> attributes(data[i++]);
+        for (auto& attr : attributes) {
+            attr.first = pool[data[i++]];
+            attr.second = pool[data[i++]];
+        }
+
+        std::string text = pool[data[i++]];
+        text += pool[data[i++]];
+
+        std::vector<std::string> lines(data[i++]);
+        for (auto& line : lines) {
+            line = pool[data[i++]];
+        }
+
+        Element ret = tag.size() > 0 ? Element(tag, attributes, text) : Element(lines);
+
+        size_t n = data[i++];
+        for (size_t j = 0; j < n; ++j) {
+            ret.push_back(decode(data, i, pool));
+        }
+
+        return ret;
+    }
+
+    // Root element of an XDMF-file.
+    inline Element document()
+    {
+        return Element("Xdmf", {{"Version", "3.0"}, {"xmlns:xi", "http://www.w3.org/2001/XInclude"}});
+    }
+
+    // Temporal collection of grids.
+    inline Element collection(const std::string& name)
+    {
+        return Element("Grid", {
+            {"CollectionType", "Temporal"},
+            {"GridType", "Collection"},
+            {"Name", name}});
+    }
+
+    // Write a complete XDMF-file.
+    template <class S, class T>
+    inline void render_document(S& sink, const T& arg)
+    {
+        render_open(sink, document(), 0);
+        render_open(sink, Element("Domain"), 1);
+        render(sink, arg, 2);
+        render_close(sink, Element("Domain"), 1);
+        render_close(sink, document(), 0);
+    }
+
+    // Check if an element is a collection of grids, or a subset of a grid.
+    inline bool is_grid(const Element& arg)
+    {
+        if (arg.tag() != "Grid") {
+            return false;
+        }
+
+        for (auto& attribute : arg.attributes()) {
+            if (attribute.first == "GridType") {
+                return attribute.second == "Collection" || attribute.second == "Subset";
+            }
+        }
+
+        return false;
+    }
+
+    // Value of an attribute of an element ("" if the element does not have the attribute).
+    inline std::string get_attribute(const Element& arg, const std::string& name)
+    {
+        for (auto& attribute : arg.attributes()) {
+            if (attribute.first == name) {
+                return attribute.second;
+            }
+        }
+        return "";
+    }
+
+    // Minimal XML parser (as written by this library: no entities, no CDATA).
+    class xml_parser
+    {
+    public:
+        xml_parser(const std::string& xml) : m_xml(xml)
+        {
+        }
+
+        // All top-level elements.
+        Element parse()
+        {
+            Element ret;
+            while (this->next_tag()) {
+                ret.push_back(this->element());
+            }
+            return ret;
+        }
+
+    private:
+        // Move to the next opening tag, skipping declarations and comments.
+        // Return false at the end of the document, or at a closing tag.
+        bool next_tag()
+        {
+            while (true) {
+                m_i = m_xml.find('<', m_i);
+                if (m_i == std::string::npos) {
+                    m_i = m_xml.size();
+                    return false;
+                }
+                if (m_xml.compare(m_i, 4, "<!--") == 0) {
+                    m_i = this->find("-->", m_i) + 3;
+                }
+                else if (m_xml.compare(m_i, 2, "<?") == 0 || m_xml.compare(m_i, 2, "<!") == 0) {
+                    m_i = this->find(">", m_i) + 1;
+                }
+                else {
+                    return m_xml.compare(m_i, 2, "</") != 0;
+                }
+            }
+        }
+
+        size_t find(const std::string& token, size_t i)
+        {
+            size_t ret = m_xml.find(token, i);
+            if (ret == std::string::npos) {
+                throw XDMFWRITE_HIGHFIVE_THROW("Unexpected end of XML");
+            }
+            return ret;
+        }
+
+        void skip_space()
+        {
+            while (m_i < m_xml.size() && std::isspace(static_cast<unsigned char>(m_xml[m_i]))) {
+                m_i++;
+            }
+        }
+
+        std::string name()
+        {
+            size_t start = m_i;
+            while (m_i < m_xml.size() &&
+                   !std::isspace(static_cast<unsigned char>(m_xml[m_i])) &&
+                   m_xml[m_i] != '>' && m_xml[m_i] != '/' && m_xml[m_i] != '=') {
+                m_i++;
+            }
+            return m_xml.substr(start, m_i - start);
+        }
+
+        static std::string trim(const std::string& arg)
+        {
+            size_t start = arg.find_first_not_of(" \t\r\n");
+            if (start == std::string::npos) {
+                return "";
+            }
+            size_t end = arg.find_last_not_of(" \t\r\n");
+            return arg.substr(start, end - start + 1);
+        }
+
+        // Element starting at the current position (at "<").
+        Element element()
+        {
+            m_i++;
+            std::string tag = this->name();
+            std::vector<std::pair<std::string, std::string>> attributes;
+
+            while (true) {
+                this->skip_space();
+                if (m_i >= m_xml.size()) {
+                    throw XDMFWRITE_HIGHFIVE_THROW("Unexpected end of XML");
+                }
+                if (m_xml[m_i] == '/' || m_xml[m_i] == '>') {
+                    break;
+                }
+                std::string key = this->name();
+                m_i = this->find("=", m_i) + 1;
+                this->skip_space();
+                char quote = m_xml[m_i];
+                size_t end = this->find(std::string(1, quote), m_i + 1);
+                attributes.emplace_back(key, m_xml.substr(m_i + 1, end - m_i - 1));
+                m_i = end + 1;
+            }
+
+            if (m_xml[m_i] == '/') {
+                m_i = this->find(">", m_i) + 1;
+                return Element(tag, attributes);
+            }
+
+            m_i++;
+            size_t start = m_i;
+            this->next_tag();
+            Element ret(tag, attributes, trim(m_xml.substr(start, m_i - start)));
+
+            while (m_i < m_xml.size() && m_xml.compare(m_i, 2, "</") != 0) {
+                ret.push_back(this->element());
+                this->next_tag();
+            }
+
+            if (m_i >= m_xml.size()) {
+                throw XDMFWRITE_HIGHFIVE_THROW("Unexpected end of XML");
+            }
+
+            m_i = this->find(">", m_i) + 1;
+            return ret;
+        }
+
+    private:
+        const std::string& m_xml;
+        size_t m_i = 0;
+    };
+
+    // Filename without directory.
+    inline std::string basename(const std::string& path)
+    {
+        size_t i = path.find_last_of("/\\");
+        return i == std::string::npos ? path : path.substr(i + 1);
+    }
+
+    // Check that all DataSets (in "file") that an element refers to exist.
+    inline bool datasets_exist(const Element& arg, const HighFive::File& file)
+    {
+        if (arg.tag() == "DataItem" && get_attribute(arg, "Format") == "HDF") {
+            const std::string& text = arg.text();
+            size_t i = text.rfind(':');
+            if (i != std::string::npos && basename(text.substr(0, i)) == basename(file.getName())) {
+                if (!file.exist(text.substr(i + 1))) {
+                    return false;
+                }
+            }
+        }
+
+        for (auto& child : arg.children()) {
+            if (!datasets_exist(child, file)) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    // Number of top-level XML elements in a sequence of strings.
+    inline size_t number_of_elements(const std::vector<std::string>& lines)
+    {
+        size_t n = 0;
+        size_t depth = 0;
+
+        for (auto& line : lines) {
+            size_t i = line.find_first_not_of(' ');
+            if (i == std::string::npos || line[i] != '<') {
+                continue;
+            }
+            if (line[i + 1] == '/') {
+                depth--;
+                continue;
+            }
+            if (depth == 0) {
+                n++;
+            }
+            if (line.find("</", i) == std::string::npos && line.rfind("/>") != line.size() - 2) {
+                depth++;
+            }
+        }
+
+        return n;
+    }
+
+    // Number of top-level XML elements.
+    inline size_t number_of_elements(const Element& arg)
+    {
+        if (arg.tag().size() > 0) {
+            return 1;
+        }
+
+        size_t n = number_of_elements(arg.lines());
+
+        for (auto& child : arg.children()) {
+            n += number_of_elements(child);
+        }
+
+        return n;
+    }
+
+    // Include the "n" fields following the Time of the first increment of a TimeSeries.
+    inline Element reference(const std::string& name, size_t n)
+    {
+        return Element("xi:include", {{"xpointer",
+            "xpointer(/Xdmf/Domain/Grid[@Name='" + name +
+            "']/Grid[1]/*[position()>1 and not(position()>" + std::to_string(n + 1) + ")])"}});
+    }
+
+    // Increments of an XDMF-file written by TimeSeries.
+    // On output: name of the TimeSeries, shared fields, and a reference to the shared fields.
+    inline std::vector<Element> increments(
+        const std::string& filename,
+        std::string& name,
+        Element& shared,
+        Element& reference)
+    {
+        std::ifstream file(filename);
+
+        if (!file.is_open()) {
+            throw XDMFWRITE_HIGHFIVE_THROW("Unable to open file");
+        }
+
+        std::string xml((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        Element document = xml_parser(xml).parse();
+
+        XDMFWRITE_HIGHFIVE_CHECK(document.children().size() == 1);
+        const Element& root = document.children()[0];
+        XDMFWRITE_HIGHFIVE_CHECK(root.tag() == "Xdmf" && root.children().size() == 1);
+        const Element& domain = root.children()[0];
+        XDMFWRITE_HIGHFIVE_CHECK(domain.tag() == "Domain" && domain.children().size() == 1);
+        const Element& collection = domain.children()[0];
+        XDMFWRITE_HIGHFIVE_CHECK(get_attribute(collection, "CollectionType") == "Temporal");
+
+        name = get_attribute(collection, "Name");
+        std::vector<Element> ret = collection.children();
+
+        shared = Element();
+        reference = Element();
+
+        // the second increment refers to the "n" shared fields of the first increment,
+        // see reference()
+        if (ret.size() > 1 && ret[1].children().size() > 1 && ret[1].children()[1].tag() == "xi:include") {
+            reference = ret[1].children()[1];
+            std::string xpointer = get_attribute(reference, "xpointer");
+            std::string token = "not(position()>";
+            size_t i = xpointer.rfind(token);
+            XDMFWRITE_HIGHFIVE_CHECK(i != std::string::npos);
+            size_t n = std::stoul(xpointer.substr(i + token.size())) - 1;
+            XDMFWRITE_HIGHFIVE_CHECK(ret[0].children().size() > n);
+            for (size_t j = 1; j <= n; ++j) {
+                shared.push_back(ret[0].children()[j]);
+            }
+        }
+
+        return ret;
+    }
+
+    // Increment (of TimeSeries or StreamingTimeSeries).
+    // "shared" are the fields shared by all increments (or a reference to them).
+    // A collection or a Subset wrapped by Increment() is used as increment.
+    inline Element increment(
+        const std::string& name,
+        const std::string& time,
+        const Element& shared,
+        std::vector<Element>&& args)
+    {
+        for (auto& arg : args) {
+            XDMFWRITE_HIGHFIVE_CHECK(arg.tag() != "Increment" || args.size() == 1);
+        }
+
+        if (args.size() == 1 && args[0].tag() == "Increment") {
+            XDMFWRITE_HIGHFIVE_CHECK(number_of_elements(shared) == 0);
+            auto& arg = args[0].children()[0];
+            Element ret(arg.tag(), arg.attributes());
+            ret.set("Name", name);
+            ret.push_back(Element("Time", {{"Value", time}}));
+            for (auto& child : arg.children()) {
+                ret.push_back(child);
+            }
+            return ret;
+        }
+
+        Element ret("Grid", {{"Name", name}});
+        ret.push_back(Element("Time", {{"Value", time}}));
+        ret.push_back(shared);
+        for (auto& arg : args) {
+            ret.push_back(std::move(arg));
+        }
+        return ret;
+    }
+
+    // Serialize partitions to send them between MPI-ranks.
+    // Per partition: "rank", "number of lines", and per line "number of characters" followed by
+    // the line itself (such that lines can contain any character, including newlines).
+    inline std::string serialize(const std::map<size_t, Element>& data)
+    {
+        std::string ret;
+
+        for (auto& item : data) {
+            auto lines = item.second.get();
+            ret += std::to_string(item.first) + "\n" + std::to_string(lines.size()) + "\n";
+            for (auto& line : lines) {
+                ret += std::to_string(line.size()) + "\n" + line;
+            }
+        }
+
+        return ret;
+    }
+
+    // Inverse of serialize().
+    inline void deserialize(const std::string& buffer, std::map<size_t, Element>& data)
+    {
+        size_t i = 0;
+
+        auto number = [&]() {
+            size_t end = buffer.find('\n', i);
+            XDMFWRITE_HIGHFIVE_CHECK(end != std::string::npos);
+            size_t ret = std::stoul(buffer.substr(i, end - i));
+            i = end + 1;
+            return ret;
+        };
+
+        while (i < buffer.size()) {
+            size_t rank = number();
+            std::vector<std::string> lines(number());
+            for (auto& line : lines) {
+                size_t n = number();
+                XDMFWRITE_HIGHFIVE_CHECK(i + n <= buffer.size());
+                line = buffer.substr(i, n);
+                i += n;
+            }
+            data[rank] = Element(lines);
+        }
+    }
+
+    // DataItem referring to a DataSet in an HDF5-file.
+    // The NumberType and Precision are only written if they are known.
+    inline Element data_item(const Metadata& data)
+    {
+        Element ret(
+            "DataItem",
+            {{"Dimensions", join_as_string(data.shape, " ")}, {"Format", "HDF"}},
+            data.filename + ":" + data.dataset);
+
+        if (data.number_type.size() > 0) {
+            ret.set("NumberType", data.number_type);
+        }
+
+        if (data.precision > 0) {
+            ret.set("Precision", std::to_string(data.precision));
+        }
+
+        return ret;
+    }
+
+    // HyperSlab DataItem: the selection (start, stride, count) followed by the source DataItem.
+    inline Element data_item(const HyperSlab& slab)
+    {
+        std::vector<size_t> selection = concatenate({slab.start, slab.stride, slab.count});
+        std::vector<size_t> shape = {3, slab.start.size()};
+
+        Element ret("DataItem", {
+            {"Dimensions", join_as_string(slab.shape, " ")},
+            {"ItemType", "HyperSlab"}});
+
+        ret.push_back(Element(
+            "DataItem",
+            {{"Dimensions", join_as_string(shape, " ")}, {"Format", "XML"}},
+            join_as_string(selection, " ")));
+
+        ret.push_back(data_item(slab.data));
+
+        return ret;
+    }
+
+    // Shape of the result of joining one-dimensional DataSets of equal size ("[n, components]").
+    inline std::vector<size_t> join_shape(const std::vector<Metadata>& components)
+    {
+        XDMFWRITE_HIGHFIVE_CHECK(components.size() > 0);
+
+        for (auto& component : components) {
+            XDMFWRITE_HIGHFIVE_CHECK(component.shape.size() == 1);
+            XDMFWRITE_HIGHFIVE_CHECK(component.shape[0] == components[0].shape[0]);
+        }
+
+        return {components[0].shape[0], components.size()};
+    }
+
+    // Function DataItem joining one-dimensional DataSets: "JOIN($0, $1, ...)".
+    inline Element join_item(const std::vector<Metadata>& components)
+    {
+        std::vector<std::string> args;
+
+        for (size_t i = 0; i < components.size(); ++i) {
+            args.push_back("$" + std::to_string(i));
+        }
+
+        Element ret("DataItem", {
+            {"Dimensions", join_as_string(join_shape(components), " ")},
+            {"Function", "JOIN(" + join(args, ", ") + ")"},
+            {"ItemType", "Function"}});
+
+        for (auto& component : components) {
+            ret.push_back(data_item(component));
+        }
+
+        return ret;
+    }
+
+    // Geometry, with a DataItem "item" of a certain shape.
+    inline Element geometry(const std::vector<size_t>& shape, const Element& item)
+    {
+        XDMFWRITE_HIGHFIVE_ASSERT(shape.size() == 2);
+
+        Element ret("Geometry");
+
+        if (shape[1] == 1) {
+            ret.set("GeometryType", "X");
+        }
+        else if (shape[1] == 2) {
+            ret.set("GeometryType", "XY");
+        }
+        else if (shape[1] == 3) {
+            ret.set("GeometryType", "XYZ");
+        }
+        else {
+            throw XDMFWRITE_HIGHFIVE_THROW("Illegal number of dimensions.");
+        }
+
+        ret.push_back(item);
+
+        return ret;
+    }
+
+    // Attribute, with a DataItem "item" of a certain shape.
+    template <class T>
+    inline Element attribute(
+        const std::vector<size_t>& shape,
+        const T& center,
+        const std::string& name,
+        const Element& item)
+    {
+        XDMFWRITE_HIGHFIVE_ASSERT(shape.size() > 0);
+        XDMFWRITE_HIGHFIVE_ASSERT(shape.size() < 4);
+
+        std::string t;
+        if (shape.size() == 1) {
+            t = "Scalar";
+        }
+        else if (shape.size() == 2 && shape[1] == 6) {
+            t = "Tensor6";
+        }
+        else if (shape.size() == 2) {
+            t = "Vector";
+        }
+        else if (shape.size() == 3 && shape[1] == 3 && shape[2] == 3) {
+            t = "Tensor";
+        }
+        else if (shape.size() == 3) {
+            t = "Matrix";
+        }
+        else {
+            throw XDMFWRITE_HIGHFIVE_THROW("Type of data cannot be deduced");
+        }
+
+        Element ret("Attribute", {
+            {"AttributeType", t},
+            {"Center", to<T>::str(center)},
+            {"Name", name}});
+
+        ret.push_back(item);
+
+        return ret;
+    }
+
+    // XDMF NumberType.
+    inline std::string number_type(bool is_float, bool is_signed, size_t precision)
+    {
+        if (is_float) {
+            return "Float";
+        }
+        if (precision == 1) {
+            return is_signed ? "Char" : "UChar";
+        }
+        return is_signed ? "Int" : "UInt";
+    }
+
+    // Polyvertex Topology of "n" points, without DataSet.
+    inline Element polyvertex(size_t n)
+    {
+        return Element("Topology", {
+            {"NodesPerElement", "1"},
+            {"NumberOfElements", std::to_string(n)},
+            {"TopologyType", "Polyvertex"}});
+    }
+
+    // Metadata of an open DataSet.
+    inline Metadata metadata(
+        const std::string& fname,
+        const std::string& path,
+        const HighFive::DataSet& dataset)
+    {
+        Metadata ret;
+        ret.filename = fname;
+        ret.dataset = path;
+        ret.shape = dataset.getDimensions();
+
+        auto dtype = dataset.getDataType();
+        auto cls = dtype.getClass();
+
+        if (cls == HighFive::DataTypeClass::Float) {
+            ret.number_type = number_type(true, true, dtype.getSize());
+            ret.precision = dtype.getSize();
+        }
+        else if (cls == HighFive::DataTypeClass::Integer) {
+            bool is_signed = H5Tget_sign(dtype.getId()) != H5T_SGN_NONE;
+            ret.number_type = number_type(false, is_signed, dtype.getSize());
+            ret.precision = dtype.getSize();
+        }
+
+        return ret;
+    }
+
+    // Metadata of a DataSet of a given shape (type unknown).
+    inline Metadata metadata(
+        const std::string& fname,
+        const std::string& dataset,
+        const std::vector<size_t>& shape)
+    {
+        Metadata ret;
+        ret.filename = fname;
+        ret.dataset = dataset;
+        ret.shape = shape;
+        return ret;
+    }
+
+    // Metadata of a DataSet of a given shape, with items of type "T".
+    template <class T>
+    inline Metadata typed_metadata(
+        const std::string& fname,
+        const std::string& dataset,
+        const std::vector<size_t>& shape)
+    {
+        Metadata ret = metadata(fname, dataset, shape);
+
+        if (std::is_arithmetic<T>::value) {
+            ret.number_type = number_type(
+                std::is_floating_point<T>::value,
+                std::is_signed<T>::value,
+                sizeof(T));
+            ret.precision = sizeof(T);
+        }
+
+        return ret;
+    }
+
+    // Metadata of a DataSet to which "data" is (or will be) written.
+    template <class E>
+    inline Metadata metadata(
+        const std::string& fname,
+        const std::string& dataset,
+        const E& data)
+    {
+        using value_type = typename std::decay_t<E>::value_type;
+        auto shape = data.shape();
+
+        return typed_metadata<value_type>(
+            fname, dataset, std::vector<size_t>(shape.cbegin(), shape.cend()));
+    }
+
+    // Metadata of a DataSet.
+    inline Metadata metadata(const HighFive::File& file, const std::string& dataset)
+    {
+        return metadata(file.getName(), dataset, file.getDataSet(dataset));
+    }
+
+    // Metadata of a DataSet, from the cache.
+    inline Metadata metadata(MetadataCache& cache, const std::string& dataset)
+    {
+        return cache.get(dataset);
+    }
+
+    // Metadata of a list of DataSets.
+    template <class F>
+    inline std::vector<Metadata> metadata(F& file, std::initializer_list<std::string> datasets)
+    {
+        std::vector<Metadata> ret;
+
+        for (auto& dataset : datasets) {
+            ret.push_back(metadata(file, dataset));
+        }
+
+        return ret;
+    }
+
+    // Open a DataSet "[time, shape...]" that is extendible along the first axis,
+    // or create it (with zero increments) if it does not exist.
+    template <class T>
+    inline HighFive::DataSet extendible_dataset(
+        HighFive::File& file,
+        const std::string& dataset,
+        const std::vector<size_t>& shape,
+        const std::vector<size_t>& chunk)
+    {
+        if (file.exist(dataset)) {
+            return file.getDataSet(dataset);
+        }
+
+        std::vector<size_t> dims = concatenate({std::vector<size_t>{0}, shape});
+        std::vector<size_t> maxdims = dims;
+        maxdims[0] = HighFive::DataSpace::UNLIMITED;
+
+        std::vector<hsize_t> c(chunk.begin(), chunk.end());
+
+        if (c.size() == 0) {
+            c = std::vector<hsize_t>(dims.begin(), dims.end());
+            c[0] = 1;
+        }
+
+        HighFive::DataSetCreateProps props;
+        props.add(HighFive::Chunking(c));
+
+        return file.createDataSet<T>(dataset, HighFive::DataSpace(dims, maxdims), props);
+    }
+
+    // Identifier of the HDF5 C-API, closed on destruction.
+    class h5_handle
+    {
+    public:
+        h5_handle(hid_t id, herr_t (*close)(hid_t)) : m_id(id), m_close(close)
+        {
+            if (id < 0) {
+                throw XDMFWRITE_HIGHFIVE_THROW("HDF5 error");
+            }
+        }
+
+        h5_handle(const h5_handle&) = delete;
+        h5_handle& operator=(const h5_handle&) = delete;
+
+        ~h5_handle()
+        {
+            m_close(m_id);
+        }
+
+        hid_t id() const
+        {
+            return m_id;
+        }
+
+    private:
+        hid_t m_id;
+        herr_t (*m_close)(hid_t);
+    };
+
+    // Throw if a function of the HDF5 C-API failed.
+    inline void h5_check(herr_t status)
+    {
+        if (status < 0) {
+            throw XDMFWRITE_HIGHFIVE_THROW("HDF5 error");
+        }
+    }
+
+    // Native HDF5 datatype for a certain NumberType and Precision.
+    inline hid_t native_type(const Metadata& data)
+    {
+        if (data.number_type == "Float") {
+            if (data.precision == 4) {
+                return H5T_NATIVE_FLOAT;
+            }
+            if (data.precision == 8) {
+                return H5T_NATIVE_DOUBLE;
+            }
+        }
+        else if (data.number_type == "Int" || data.number_type == "Char") {
+            switch (data.precision) {
+                case 1: return H5T_NATIVE_INT8;
+                case 2: return H5T_NATIVE_INT16;
+                case 4: return H5T_NATIVE_INT32;
+                case 8: return H5T_NATIVE_INT64;
+            }
+        }
+        else if (data.number_type == "UInt" || data.number_type == "UChar") {
+            switch (data.precision) {
+                case 1: return H5T_NATIVE_UINT8;
+                case 2: return H5T_NATIVE_UINT16;
+                case 4: return H5T_NATIVE_UINT32;
+                case 8: return H5T_NATIVE_UINT64;
+            }
+        }
+        throw XDMFWRITE_HIGHFIVE_THROW("Unknown type of DataSet");
+    }
+
+    // Call "func(path, dataset)" for all DataSets in a group (recursively).
+    template <class G, class F>
+    inline void visit_datasets(const G& group, const std::string& path, F& func)
+    {
+        for (auto& name : group.listObjectNames()) {
+            std::string p = path == "/" ? "/" + name : path + "/" + name;
+            auto type = group.getObjectType(name);
+            if (type == HighFive::ObjectType::Dataset) {
+                func(p, group.getDataSet(name));
+            }
+            else if (type == HighFive::ObjectType::Group) {
+                visit_datasets(group.getGroup(name), p, func);
+            }
+        }
+    }
+
+} // namespace detail
+
+inline std::string join(const std::vector<std::string>& lines, const std::string& sep)
+{
+    if (lines.size() == 1) {
+        return lines[0];
+    }
+
+    std::string ret = "";
+
+    for (auto& line : lines) {
+        if (ret.size() == 0) {
+            ret += line;
+            continue;
+        }
+
+        if (line[0] == sep[0]) {
+            ret += line;
+        }
+        else if (ret[ret.size() - 1] == sep[0]) {
+            ret += line;
+        }
+        else {
+            ret += sep + line;
+        }
+    }
+
+    return ret;
+}
+
+inline Element::Element(const std::string& tag) : m_tag(tag)
+{
+}
+
+inline Element::Element(
+    const std::string& tag,
+    const std::vector<std::pair<std::string, std::string>>& attributes,
+    const std::string& text)
+    : m_tag(tag), m_attributes(attributes), m_text(text)
+{
+}
+
+inline Element::Element(const std::vector<std::string>& lines) : m_lines(lines)
+{
+}
+
+inline Element& Element::set(const std::string& name, const std::string& value)
+{
+    for (auto& attribute : m_attributes) {
+        if (attribute.first == name) {
+            attribute.second = value;
+            return *this;
+        }
+    }
+    m_attributes.push_back(std::make_pair(name, value));
+    return *this;
+}
+
+inline Element& Element::set_text(const std::string& text)
+{
+    m_text = text;
+    return *this;
+}
+
+inline Element& Element::push_back(const Element& child)
+{
+    m_children.push_back(child);
+    return *this;
+}
+
+inline Element& Element::push_back(Element&& child)
+{
+    m_children.push_back(std::move(child));
+    return *this;
+}
+
+inline const std::string& Element::tag() const
+{
+    return m_tag;
+}
+
+inline const std::vector<std::pair<std::string, std::string>>& Element::attributes() const
+{
+    return m_attributes;
+}
+
+inline const std::string& Element::text() const
+{
+    return m_text;
+}
+
+inline const std::vector<std::string>& Element::lines() const
+{
+    return m_lines;
+}
+
+inline const std::vector<Element>& Element::children() const
+{
+    return m_children;
+}
+
+inline std::vector<std::string> Element::get() const
+{
+    std::vector<std::string> ret;
+    detail::lines_sink sink(ret);
+    detail::render(sink, *this, 0);
+    return ret;
+}
+
+inline Element::operator std::vector<std::string>() const
+{
+    return this->get();
+}
+
+inline bool operator==(const Element& a, const Element& b)
+{
+    return a.get() == b.get();
+}
+
+inline bool operator!=(const Element& a, const Element& b)
+{
+    return !(a == b);
+}
+
+template <class T>
+inline std::vector<T> concatenate(std::initializer_list<std::vector<T>> args)
+{
+    size_t n = 0;
+    for (auto& arg : args) {
+        n += arg.size();
+    }
+    std::vector<T> ret;
+    ret.reserve(n);
+    for (auto& arg : args) {
+        ret.insert(ret.end(), arg.begin(), arg.end());
+    }
+    return ret;
+}
+
+inline Element concatenate(std::initializer_list<Element> args)
+{
+    return concatenate(args.begin(), args.end());
+}
+
+template <class T>
+inline std::vector<T> concatenate(std::vector<std::vector<T>>&& args)
+{
+    if (args.size() == 0) {
+        return {};
+    }
+
+    size_t n = 0;
+    for (auto& arg : args) {
+        n += arg.size();
+    }
+    std::vector<T> ret = std::move(args[0]);
+    ret.reserve(n);
+    for (size_t i = 1; i < args.size(); ++i) {
+        ret.insert(ret.end(),
+            std::make_move_iterator(args[i].begin()),
+            std::make_move_iterator(args[i].end()));
+    }
+    return ret;
+}
+
+inline Element concatenate(std::vector<Element>&& args)
+{
+    return concatenate(std::make_move_iterator(args.begin()), std::make_move_iterator(args.end()));
+}
+
+template <class Iterator>
+inline Element concatenate(Iterator first, Iterator last)
+{
+    Element ret;
+    for (; first != last; ++first) {
+        ret.push_back(*first);
+    }
+    return ret;
+}
+
+inline MetadataCache::MetadataCache(const HighFive::File& file)
+    : m_file(file), m_filename(file.getName())
+{
+}
+
+inline MetadataCache::MetadataCache(const HighFive::File& file, const std::string& filename)
+    : m_file(file), m_filename(filename)
+{
+}
+
+inline const Metadata& MetadataCache::get(const std::string& dataset)
+{
+    auto it = m_data.find(dataset);
+
+    if (it != m_data.end()) {
+        return it->second;
+    }
+
+    auto data = detail::metadata(m_filename, dataset, m_file.getDataSet(dataset));
+    return m_data.emplace(dataset, std::move(data)).first->second;
+}
+
+inline bool MetadataCache::contains(const std::string& dataset) const
+{
+    return m_data.find(dataset) != m_data.end();
+}
+
+inline void MetadataCache::prefetch()
+{
+    auto func = [this](const std::string& path, const HighFive::DataSet& dataset) {
+        m_data[path] = detail::metadata(m_filename, path, dataset);
+    };
+
+    detail::visit_datasets(m_file, "/", func);
+}
+
+inline void MetadataCache::prefetch(const std::string& group)
+{
+    if (group == "/") {
+        return prefetch();
+    }
+
+    auto func = [this](const std::string& path, const HighFive::DataSet& dataset) {
+        m_data[path] = detail::metadata(m_filename, path, dataset);
+    };
+
+    detail::visit_datasets(m_file.getGroup(group), group, func);
+}
+
+inline void MetadataCache::invalidate(const std::string& dataset)
+{
+    m_data.erase(dataset);
+}
+
+inline void MetadataCache::clear()
+{
+    m_data.clear();
+}
+
+inline const HighFive::File& MetadataCache::file() const
+{
+    return m_file;
+}
+
+inline std::vector<std::string> MetadataCache::datasets() const
+{
+    std::vector<std::string> ret;
+    ret.reserve(m_data.size());
+    for (auto& item : m_data) {
+        ret.push_back(item.first);
+    }
+    return ret;
+}
+
+inline HyperSlab::HyperSlab(
+    const Metadata& data_,
+    const std::vector<size_t>& start_,
+    const std::vector<size_t>& stride_,
+    const std::vector<size_t>& count_,
+    const std::vector<size_t>& shape_)
+    : data(data_), start(start_), stride(stride_), count(count_), shape(shape_)
+{
+    if (shape.size() == 0) {
+        shape = count;
+    }
+
+    XDMFWRITE_HIGHFIVE_ASSERT(start.size() == data.shape.size());
+    XDMFWRITE_HIGHFIVE_ASSERT(stride.size() == data.shape.size());
+    XDMFWRITE_HIGHFIVE_ASSERT(count.size() == data.shape.size());
+}
+
+inline HyperSlab::HyperSlab(const Metadata& data_, size_t index)
+    : data(data_)
+{
+    size_t rank = data.shape.size();
+
+    XDMFWRITE_HIGHFIVE_ASSERT(rank > 1);
+    XDMFWRITE_HIGHFIVE_ASSERT(index < data.shape[0]);
+
+    start = std::vector<size_t>(rank, 0);
+    stride = std::vector<size_t>(rank, 1);
+    count = data.shape;
+    start[0] = index;
+    count[0] = 1;
+    shape = std::vector<size_t>(data.shape.begin() + 1, data.shape.end());
+}
+
+inline Element Geometry(
+    const HighFive::File& file,
+    const std::string& dataset)
+{
+    return Geometry(detail::metadata(file, dataset));
+}
+
+inline Element Geometry(
+    MetadataCache& cache,
+    const std::string& dataset)
+{
+    return Geometry(cache.get(dataset));
+}
+
+inline Element Geometry(
+    const std::string& filename,
+    const std::string& dataset,
+    const std::vector<size_t>& shape)
+{
+    return Geometry(detail::metadata(filename, dataset, shape));
+}
+
+template <class E, typename>
+inline Element Geometry(
+    const std::string& filename,
+    const std::string& dataset,
+    const E& data)
+{
+    return Geometry(detail::metadata(filename, dataset, data));
+}
+
+inline Element Geometry(
+    const Metadata& data)
+{
+    return detail::geometry(data.shape, detail::data_item(data));
+}
+
+inline Element Geometry(
+    const HyperSlab& slab)
+{
+    return detail::geometry(slab.shape, detail::data_item(slab));
+}
+
+inline Element Geometry(
+    const HighFive::File& file,
+    const std::string& dataset,
+    size_t index)
+{
+    return Geometry(HyperSlab(detail::metadata(file, dataset), index));
+}
+
+inline Element Geometry(
+    MetadataCache& cache,
+    const std::string& dataset,
+    size_t index)
+{
+    return Geometry(HyperSlab(cache.get(dataset), index));
+}
+
+inline Element Geometry(
+    const HighFive::File& file,
+    std::initializer_list<std::string> datasets)
+{
+    return Geometry(detail::metadata(file, datasets));
+}
+
+inline Element Geometry(
+    MetadataCache& cache,
+    std::initializer_list<std::string> datasets)
+{
+    return Geometry(detail::metadata(cache, datasets));
+}
+
+inline Element Geometry(
+    const std::vector<Metadata>& components)
+{
+    detail::join_shape(components);
+
+    Element ret("Geometry");
+
+    if (components.size() == 2) {
+        ret.set("GeometryType", "X_Y");
+    }
+    else if (components.size() == 3) {
+        ret.set("GeometryType", "X_Y_Z");
+    }
+    else {
+        throw XDMFWRITE_HIGHFIVE_THROW("Illegal number of dimensions.");
+    }
+
+    for (auto& component : components) {
+        ret.push_back(detail::data_item(component));
+    }
+
+    return ret;
+}
+
+template <class T>
+inline Element Topology(
+    const HighFive::File& file,
+    const std::string& dataset,
+    const T& type)
+{
+    return Topology(detail::metadata(file, dataset), type);
+}
+
+template <class T>
+inline Element Topology(
+    MetadataCache& cache,
+    const std::string& dataset,
+    const T& type)
+{
+    return Topology(cache.get(dataset), type);
+}
+
+template <class T>
+inline Element Topology(
+    const std::string& filename,
+    const std::string& dataset,
+    const std::vector<size_t>& shape,
+    const T& type)
+{
+    return Topology(detail::metadata(filename, dataset, shape), type);
+}
+
+template <class E, class T, typename>
+inline Element Topology(
+    const std::string& filename,
+    const std::string& dataset,
+    const E& data,
+    const T& type)
+{
+    return Topology(detail::metadata(filename, dataset, data), type);
+}
+
+template <class T>
+inline Element Topology(
+    const Metadata& data,
+    const T& type)
+{
+    auto& shape = data.shape;
+
+    XDMFWRITE_HIGHFIVE_ASSERT(detail::check_shape(shape, type));
+
+    Element ret("Topology", {
+        {"NumberOfElements", std::to_string(shape[0])},
+        {"TopologyType", detail::to<T>::str(type)}});
+
+    ret.push_back(detail::data_item(data));
+
+    return ret;
+}
+
+inline Element Topology(
+    ElementType type,
+    size_t number_of_elements)
+{
+    XDMFWRITE_HIGHFIVE_CHECK(type == ElementType::Polyvertex);
+    return detail::polyvertex(number_of_elements);
+}
+
+inline Element MixedTopology(
+    const HighFive::File& file,
+    const std::string& dataset,
+    size_t number_of_elements)
+{
+    return MixedTopology(detail::metadata(file, dataset), number_of_elements);
+}
+
+inline Element MixedTopology(
+    MetadataCache& cache,
+    const std::string& dataset,
+    size_t number_of_elements)
+{
+    return MixedTopology(cache.get(dataset), number_of_elements);
+}
+
+inline Element MixedTopology(
+    const Metadata& data,
+    size_t number_of_elements)
+{
+    XDMFWRITE_HIGHFIVE_ASSERT(data.shape.size() == 1);
+
+    Element ret("Topology", {
+        {"NumberOfElements", std::to_string(number_of_elements)},
+        {"TopologyType", "Mixed"}});
+
+    ret.push_back(detail::data_item(data));
+
+    return ret;
+}
+
+inline ElementType element_type(const std::string& name)
+{
+    for (auto type : {
+             ElementType::Polyvertex,
+             ElementType::Triangle,
+             ElementType::Quadrilateral,
+             ElementType::Hexahedron,
+             ElementType::Tetrahedron,
+             ElementType::Pyramid,
+             ElementType::Wedge,
+             ElementType::Triangle_6,
+             ElementType::Quadrilateral_8,
+             ElementType::Hexahedron_20}) {
+        if (detail::to<ElementType>::str(type) == name) {
+            return type;
+        }
+    }
+
+    throw XDMFWRITE_HIGHFIVE_THROW("Unknown ElementType");
+}
+
+template <class T, class E>
+inline std::vector<size_t> mixed_connectivity(const T& type, const E& conn)
+{
+    auto t = detail::to<T>::type(type);
+    auto shape = conn.shape();
+    size_t n = static_cast<size_t>(shape[0]);
+    size_t m = detail::nodes_per_element(t);
+    auto data = conn.data();
+
+    XDMFWRITE_HIGHFIVE_ASSERT(detail::check_shape(shape, type));
+
+    size_t header = t == ElementType::Polyvertex ? 2 : 1;
+    std::vector<size_t> ret;
+    ret.reserve(n * (m + header));
+
+    for (size_t e = 0; e < n; ++e) {
+        ret.push_back(detail::type_code(t));
+        if (t == ElementType::Polyvertex) {
+            ret.push_back(1);
+        }
+        for (size_t i = 0; i < m; ++i) {
+            ret.push_back(static_cast<size_t>(data[e * m + i]));
+        }
+    }
+
+    return ret;
+}
+
+inline Element Structured(
+    const HighFive::File& file,
+    const std::string& dataset_geometry)
+{
+    return Structured(detail::metadata(file, dataset_geometry));
+}
+
+inline Element Structured(
+    MetadataCache& cache,
+    const std::string& dataset_geometry)
+{
+    return Structured(cache.get(dataset_geometry));
+}
+
+inline Element Structured(
+    const Metadata& geometry)
+{
+    XDMFWRITE_HIGHFIVE_ASSERT(geometry.shape.size() == 2);
+
+    return concatenate({
+        Geometry(geometry),
+        detail::polyvertex(geometry.shape[0])});
+}
+
+inline Element Structured(
+    const HighFive::File& file,
+    const std::string& dataset_geometry,
+    const std::string& dataset_topology)
+{
+    auto geometry = detail::metadata(file, dataset_geometry);
+    auto topology = detail::metadata(file, dataset_topology);
+
+    XDMFWRITE_HIGHFIVE_ASSERT(geometry.shape[0] == topology.shape[0]);
+
+    return concatenate({
+        Geometry(geometry),
+        Topology(topology, ElementType::Polyvertex)});
+}
+
+inline Element Structured(
+    MetadataCache& cache,
+    const std::string& dataset_geometry,
+    const std::string& dataset_topology)
+{
+    auto& geometry = cache.get(dataset_geometry);
+    auto& topology = cache.get(dataset_topology);
+
+    XDMFWRITE_HIGHFIVE_ASSERT(geometry.shape[0] == topology.shape[0]);
+
+    return concatenate({
+        Geometry(geometry),
+        Topology(topology, ElementType::Polyvertex)});
+}
+
+inline Element Structured(
+    const HyperSlab& geometry)
+{
+    XDMFWRITE_HIGHFIVE_ASSERT(geometry.shape.size() == 2);
+
+    return concatenate({
+        Geometry(geometry),
+        detail::polyvertex(geometry.shape[0])});
+}
+
+template <class T>
+inline Element Unstructured(
+    const HighFive::File& file,
+    const std::string& dataset_geometry,
+    const std::string& dataset_topology,
+    const T& type)
+{
+    return concatenate({
+        Geometry(file, dataset_geometry),
+        Topology(file, dataset_topology, type)});
+}
+
+template <class T>
+inline Element Unstructured(
+    MetadataCache& cache,
+    const std::string& dataset_geometry,
+    const std::string& dataset_topology,
+    const T& type)
+{
+    return concatenate({
+        Geometry(cache, dataset_geometry),
+        Topology(cache, dataset_topology, type)});
+}
+
+inline Element RegularGrid(
+    const std::vector<size_t>& shape,
+    const std::vector<double>& origin,
+    const std::vector<double>& spacing)
+{
+    XDMFWRITE_HIGHFIVE_CHECK(shape.size() == 2 || shape.size() == 3);
+    XDMFWRITE_HIGHFIVE_CHECK(origin.size() == shape.size());
+    XDMFWRITE_HIGHFIVE_CHECK(spacing.size() == shape.size());
+
+    std::string rank = std::to_string(shape.size());
+    std::string type = shape.size() == 2 ? "ORIGIN_DXDY" : "ORIGIN_DXDYDZ";
+
+    Element topology("Topology", {
+        {"Dimensions", detail::join_as_string(shape, " ")},
+        {"TopologyType", rank + "DCoRectMesh"}});
+
+    Element geometry("Geometry", {{"GeometryType", type}});
+
+    for (auto& data : {origin, spacing}) {
+        std::vector<std::string> values;
+        for (auto& value : data) {
+            values.push_back(detail::round_trip(value));
+        }
+        geometry.push_back(Element("DataItem", {
+            {"Dimensions", rank},
+            {"Format", "XML"},
+            {"NumberType", "Float"},
+            {"Precision", "8"}},
+            join(values, " ")));
+    }
+
+    return concatenate({topology, geometry});
+}
+
+inline Element RectilinearGrid(
+    const HighFive::File& file,
+    const std::vector<std::string>& datasets)
+{
+    std::vector<Metadata> axes;
+
+    for (auto& dataset : datasets) {
+        axes.push_back(detail::metadata(file, dataset));
+    }
+
+    return RectilinearGrid(axes);
+}
+
+inline Element RectilinearGrid(
+    MetadataCache& cache,
+    const std::vector<std::string>& datasets)
+{
+    std::vector<Metadata> axes;
+
+    for (auto& dataset : datasets) {
+        axes.push_back(cache.get(dataset));
+    }
+
+    return RectilinearGrid(axes);
+}
+
+inline Element RectilinearGrid(
+    const std::vector<Metadata>& axes)
+{
+    XDMFWRITE_HIGHFIVE_CHECK(axes.size() == 2 || axes.size() == 3);
+
+    std::vector<size_t> shape;
+
+    for (auto& axis : axes) {
+        XDMFWRITE_HIGHFIVE_ASSERT(axis.shape.size() == 1);
+        shape.push_back(axis.shape[0]);
+    }
+
+    std::string rank = std::to_string(axes.size());
+    std::string type = axes.size() == 2 ? "VXVY" : "VXVYVZ";
+
+    Element topology("Topology", {
+        {"Dimensions", detail::join_as_string(shape, " ")},
+        {"TopologyType", rank + "DRectMesh"}});
+
+    Element geometry("Geometry", {{"GeometryType", type}});
+
+    // "VX" (the last axis in C-order) is written first
+    for (auto it = axes.rbegin(); it != axes.rend(); ++it) {
+        geometry.push_back(detail::data_item(*it));
+    }
+
+    return concatenate({topology, geometry});
+}
+
+template <class T>
+inline Element Attribute(
+    const HighFive::File& file,
+    const std::string& dataset,
+    const T& center,
+    const std::string &name)
+{
+    return Attribute(detail::metadata(file, dataset), center, name);
+}
+
+template <class T>
+inline Element Attribute(
+    MetadataCache& cache,
+    const std::string& dataset,
+    const T& center,
+    const std::string& name)
+{
+    return Attribute(cache.get(dataset), center, name);
+}
+
+template <class T>
+inline Element Attribute(
+    MetadataCache& cache,
+    const std::string& dataset,
+    const T& center)
+{
+    return Attribute(cache.get(dataset), center, dataset);
+}
+
+template <class T>
+inline Element Attribute(
+    const Metadata& data,
+    const T& center)
+{
+    return Attribute(data, center, data.dataset);
+}
+
+template <class T>
+inline Element Attribute(
+    const std::string& filename,
+    const std::string& dataset,
+    const std::vector<size_t>& shape,
+    const T& center)
+{
+    return Attribute(detail::metadata(filename, dataset, shape), center, dataset);
+}
+
+template <class T>
+inline Element Attribute(
+    const std::string& filename,
+    const std::string& dataset,
+    const std::vector<size_t>& shape,
+    const T& center,
+    const std::string& name)
+{
+    return Attribute(detail::metadata(filename, dataset, shape), center, name);
+}
+
+template <class E, class T, typename>
+inline Element Attribute(
+    const std::string& filename,
+    const std::string& dataset,
+    const E& data,
+    const T& center)
+{
+    return Attribute(detail::metadata(filename, dataset, data), center, dataset);
+}
+
+template <class E, class T, typename>
+inline Element Attribute(
+    const std::string& filename,
+    const std::string& dataset,
+    const E& data,
+    const T& center,
+    const std::string& name)
+{
+    return Attribute(detail::metadata(filename, dataset, data), center, name);
+}
+
+template <class T>
+inline Element Attribute(
+    const Metadata& data,
+    const T& center,
+    const std::string& name)
+{
+    return detail::attribute(data.shape, center, name, detail::data_item(data));
+}
+
+template <class T>
+inline Element Attribute(
+    const HyperSlab& slab,
+    const T& center)
+{
+    return Attribute(slab, center, slab.data.dataset);
+}
+
+template <class T>
+inline Element Attribute(
+    const HyperSlab& slab,
+    const T& center,
+    const std::string& name)
+{
+    return detail::attribute(slab.shape, center, name, detail::data_item(slab));
+}
+
+template <class T>
+inline Element Attribute(
+    const HighFive::File& file,
+    const std::string& dataset,
+    size_t index,
+    const T& center)
+{
+    return Attribute(HyperSlab(detail::metadata(file, dataset), index), center, dataset);
+}
+
+template <class T>
+inline Element Attribute(
+    const HighFive::File& file,
+    const std::string& dataset,
+    size_t index,
+    const T& center,
+    const std::string& name)
+{
+    return Attribute(HyperSlab(detail::metadata(file, dataset), index), center, name);
+}
+
+template <class T>
+inline Element Attribute(
+    MetadataCache& cache,
+    const std::string& dataset,
+    size_t index,
+    const T& center)
+{
+    return Attribute(HyperSlab(cache.get(dataset), index), center, dataset);
+}
+
+template <class T>
+inline Element Attribute(
+    MetadataCache& cache,
+    const std::string& dataset,
+    size_t index,
+    const T& center,
+    const std::string& name)
+{
+    return Attribute(HyperSlab(cache.get(dataset), index), center, name);
+}
+
+template <class T>
+inline Element Attribute(
+    const HighFive::File& file,
+    std::initializer_list<std::string> datasets,
+    const T& center,
+    const std::string& name)
+{
+    return Attribute(detail::metadata(file, datasets), center, name);
+}
+
+template <class T>
+inline Element Attribute(
+    MetadataCache& cache,
+    std::initializer_list<std::string> datasets,
+    const T& center,
+    const std::string& name)
+{
+    return Attribute(detail::metadata(cache, datasets), center, name);
+}
+
+template <class T>
+inline Element Attribute(
+    const std::vector<Metadata>& components,
+    const T& center,
+    const std::string& name)
+{
+    return detail::attribute(
+        detail::join_shape(components), center, name, detail::join_item(components));
+}
+
+template <class T>
+inline Element Attribute(
+    const HighFive::File& file,
+    const std::string& dataset,
+    const T& center)
+{
+    return Attribute(file, dataset, center, dataset);
+}
+
+template <class T>
+inline AppendableField<T>::AppendableField(
+    HighFive::File& file,
+    const std::string& dataset,
+    const std::vector<size_t>& shape,
+    const std::vector<size_t>& chunk,
+    size_t growth)
+    : m_dataset(detail::extendible_dataset<T>(file, dataset, shape, chunk)), m_growth(growth)
+{
+    XDMFWRITE_HIGHFIVE_CHECK(growth > 0);
+
+    auto dims = m_dataset.getDimensions();
+
+    XDMFWRITE_HIGHFIVE_CHECK(dims.size() == shape.size() + 1);
+    XDMFWRITE_HIGHFIVE_CHECK(std::equal(shape.begin(), shape.end(), dims.begin() + 1));
+
+    m_capacity = dims[0];
+
+    if (m_dataset.hasAttribute("size")) {
+        m_dataset.getAttribute("size").read(dims[0]);
+        XDMFWRITE_HIGHFIVE_CHECK(dims[0] <= m_capacity);
+    }
+    else {
+        m_dataset.createAttribute<size_t>("size", HighFive::DataSpace::From(dims[0])).write(dims[0]);
+    }
+
+    m_data = detail::typed_metadata<T>(file.getName(), dataset, dims);
+    m_size = 1;
+
+    for (auto& i : shape) {
+        m_size *= i;
+    }
+}
+
+template <class T>
+template <class E>
+inline HyperSlab AppendableField<T>::append(const E& data)
+{
+    XDMFWRITE_HIGHFIVE_CHECK(static_cast<size_t>(data.size()) == m_size);
+
+    size_t n = m_data.shape[0];
+
+    if (n == m_capacity) {
+        std::vector<size_t> dims = m_data.shape;
+        m_capacity += m_growth;
+        dims[0] = m_capacity;
+        m_dataset.resize(dims);
+    }
+
+    std::vector<size_t> offset(m_data.shape.size(), 0);
+    std::vector<size_t> count = m_data.shape;
+    offset[0] = n;
+    count[0] = 1;
+
+    m_dataset.select(offset, count).write_raw(data.data());
+
+    // the selection refers to the increments written (never to reserved room),
+    // such that it stays valid after shrink_to_fit()
+    m_data.shape[0] = n + 1;
+    m_dataset.getAttribute("size").write(m_data.shape[0]);
+
+    return HyperSlab(m_data, n);
+}
+
+template <class T>
+inline HyperSlab AppendableField<T>::slab(size_t index) const
+{
+    XDMFWRITE_HIGHFIVE_ASSERT(index < m_data.shape[0]);
+    return HyperSlab(m_data, index);
+}
+
+template <class T>
+inline size_t AppendableField<T>::size() const
+{
+    return m_data.shape[0];
+}
+
+template <class T>
+inline Metadata AppendableField<T>::metadata() const
+{
+    return m_data;
+}
+
+template <class T>
+inline void AppendableField<T>::shrink_to_fit()
+{
+    if (m_data.shape[0] != m_capacity) {
+        m_capacity = m_data.shape[0];
+        m_dataset.resize(m_data.shape);
+    }
+}
+
+template <class T>
+inline RaggedField<T>::RaggedField(
+    HighFive::File& file,
+    const std::string& dataset,
+    const std::vector<size_t>& shape,
+    const std::string& offsets,
+    size_t chunk)
+    : m_dataset(detail::extendible_dataset<T>(
+          file, dataset, shape, concatenate({std::vector<size_t>{chunk}, shape}))),
+      m_offsets(detail::extendible_dataset<size_t>(
+          file, offsets.size() > 0 ? offsets : dataset + "_offsets", {}, {chunk}))
+{
+    auto dims = m_dataset.getDimensions();
+
+    XDMFWRITE_HIGHFIVE_CHECK(dims.size() == shape.size() + 1);
+    XDMFWRITE_HIGHFIVE_CHECK(std::equal(shape.begin(), shape.end(), dims.begin() + 1));
+
+    m_data = detail::typed_metadata<T>(file.getName(), dataset, dims);
+    m_size = 1;
+
+    for (auto& i : shape) {
+        m_size *= i;
+    }
+
+    if (m_offsets.getDimensions()[0] == 0) {
+        m_index = {0};
+        m_offsets.resize({1});
+        m_offsets.select({0}, {1}).write_raw(m_index.data());
+    }
+    else {
+        m_offsets.read(m_index);
+    }
+
+    XDMFWRITE_HIGHFIVE_CHECK(m_index.back() == dims[0]);
+}
+
+template <class T>
+template <class E>
+inline HyperSlab RaggedField<T>::append(const E& data)
+{
+    size_t size = static_cast<size_t>(data.size());
+
+    XDMFWRITE_HIGHFIVE_CHECK(size % m_size == 0);
+
+    size_t offset = m_index.back();
+    size_t n = size / m_size;
+
+    if (n > 0) {
+        m_data.shape[0] = offset + n;
+        m_dataset.resize(m_data.shape);
+
+        std::vector<size_t> start(m_data.shape.size(), 0);
+        std::vector<size_t> count = m_data.shape;
+        start[0] = offset;
+        count[0] = n;
+
+        m_dataset.select(start, count).write_raw(data.data());
+    }
+
+    m_index.push_back(offset + n);
+    m_offsets.resize({m_index.size()});
+    m_offsets.select({m_index.size() - 1}, {1}).write_raw(&m_index.back());
+
+    return slab(m_index.size() - 2);
+}
+
+template <class T>
+inline HyperSlab RaggedField<T>::slab(size_t index) const
+{
+    XDMFWRITE_HIGHFIVE_ASSERT(index + 1 < m_index.size());
+
+    size_t rank = m_data.shape.size();
+    std::vector<size_t> start(rank, 0);
+    std::vector<size_t> stride(rank, 1);
+    std::vector<size_t> count = m_data.shape;
+    start[0] = m_index[index];
+    count[0] = m_index[index + 1] - m_index[index];
+
+    return HyperSlab(m_data, start, stride, count);
+}
+
+template <class T>
+inline size_t RaggedField<T>::size() const
+{
+    return m_index.size() - 1;
+}
+
+template <class T>
+inline Metadata RaggedField<T>::metadata() const
+{
+    return m_data;
+}
+
+inline Metadata VirtualDataSet(
+    HighFive::File& file,
+    const std::string& dataset,
+    const std::vector<Metadata>& sources)
+{
+    XDMFWRITE_HIGHFIVE_CHECK(sources.size() > 0);
+
+    auto& first = sources.front();
+    std::vector<size_t> shape = first.shape;
+    shape[0] = 0;
+
+    for (auto& source : sources) {
+        XDMFWRITE_HIGHFIVE_CHECK(source.shape.size() == first.shape.size());
+        XDMFWRITE_HIGHFIVE_CHECK(std::equal(
+            source.shape.begin() + 1, source.shape.end(), first.shape.begin() + 1));
+        XDMFWRITE_HIGHFIVE_CHECK(source.number_type == first.number_type);
+        XDMFWRITE_HIGHFIVE_CHECK(source.precision == first.precision);
+        shape[0] += source.shape[0];
+    }
+
+    hid_t type = detail::native_type(first);
+
+    std::vector<hsize_t> dims(shape.begin(), shape.end());
+    int rank = static_cast<int>(dims.size());
+    detail::h5_handle vspace(H5Screate_simple(rank, dims.data(), nullptr), H5Sclose);
+    detail::h5_handle dcpl(H5Pcreate(H5P_DATASET_CREATE), H5Pclose);
+    std::vector<hsize_t> start(dims.size(), 0);
+
+    for (auto& source : sources) {
+        std::vector<hsize_t> count(source.shape.begin(), source.shape.end());
+        detail::h5_handle sspace(H5Screate_simple(rank, count.data(), nullptr), H5Sclose);
+        std::string fname = source.filename == file.getName() ? "." : source.filename;
+        detail::h5_check(H5Sselect_hyperslab(
+            vspace.id(), H5S_SELECT_SET, start.data(), nullptr, count.data(), nullptr));
+        detail::h5_check(H5Pset_virtual(
+            dcpl.id(), vspace.id(), fname.c_str(), source.dataset.c_str(), sspace.id()));
+        start[0] += count[0];
+    }
+
+    detail::h5_check(H5Sselect_all(vspace.id()));
+
+    detail::h5_handle lcpl(H5Pcreate(H5P_LINK_CREATE), H5Pclose);
+    detail::h5_check(H5Pset_create_intermediate_group(lcpl.id(), 1));
+
+    detail::h5_handle id(
+        H5Dcreate2(file.getId(), dataset.c_str(), type, vspace.id(), lcpl.id(), dcpl.id(), H5P_DEFAULT),
+        H5Dclose);
+
+    Metadata ret = first;
+    ret.filename = file.getName();
+    ret.dataset = dataset;
+    ret.shape = shape;
+
+    return ret;
+}
+
+inline Element Grid(
+    const std::string& name,
+    std::initializer_list<Element> args)
+{
+    return Grid(name, args.begin(), args.end());
+}
+
+inline Element Grid(std::initializer_list<Element> args)
+{
+    return Grid("Grid", args);
+}
+
+inline Element Grid(
+    const std::string& name,
+    std::vector<Element>&& args)
+{
+    return Grid(name, std::make_move_iterator(args.begin()), std::make_move_iterator(args.end()));
+}
+
+template <class Iterator>
+inline Element Grid(
+    const std::string& name,
+    Iterator first,
+    Iterator last)
+{
+    Element grid("Grid", {{"Name", name}});
+    for (; first != last; ++first) {
+        grid.push_back(*first);
+    }
+
+    Element ret = detail::collection(name);
+    ret.push_back(std::move(grid));
+    return ret;
+}
+
+inline GridBuilder::GridBuilder(const std::string& name) : m_name(name)
+{
+}
+
+inline GridBuilder& GridBuilder::add(const Element& arg)
+{
+    m_data.push_back(arg);
+    return *this;
+}
+
+inline GridBuilder& GridBuilder::add(Element&& arg)
+{
+    m_data.push_back(std::move(arg));
+    return *this;
+}
+
+inline void GridBuilder::reserve(size_t n)
+{
+    m_data.reserve(n);
+}
+
+inline size_t GridBuilder::size() const
+{
+    return m_data.size();
+}
+
+inline Element GridBuilder::get() const
+{
+    return Grid(m_name, m_data.begin(), m_data.end());
+}
+
+inline std::vector<Element> GridBuilder::release()
+{
+    std::vector<Element> ret = std::move(m_data);
+    m_data.clear();
+    return ret;
+}
+
+inline Element Subset(
+    const HighFive::File& file,
+    const std::string& dataset,
+    const std::string& target,
+    const std::string& name,
+    std::initializer_list<Element> args)
+{
+    return Subset(detail::metadata(file, dataset), target, name, args);
+}
+
+inline Element Subset(
+    MetadataCache& cache,
+    const std::string& dataset,
+    const std::string& target,
+    const std::string& name,
+    std::initializer_list<Element> args)
+{
+    return Subset(cache.get(dataset), target, name, args);
+}
+
+inline Element Subset(
+    const Metadata& index,
+    const std::string& target,
+    const std::string& name,
+    std::initializer_list<Element> args)
+{
+    XDMFWRITE_HIGHFIVE_ASSERT(index.shape.size() == 1);
+
+    std::string xpath = target;
+
+    // Grid() wraps the grid in a collection with the same name: refer to the grid itself
+    if (target.size() == 0 || target[0] != '/') {
+        xpath = "/Xdmf/Domain//Grid[@Name='" + target + "' and not(@GridType='Collection')]";
+    }
+
+    Element ret("Grid", {
+        {"GridType", "Subset"},
+        {"Name", name},
+        {"Section", "DataItem"}});
+
+    ret.push_back(detail::data_item(index));
+    ret.push_back(Element("Grid", {{"Name", "Target"}, {"Reference", "XML"}}, xpath));
+
+    for (auto& arg : args) {
+        ret.push_back(arg);
+    }
+
+    return ret;
+}
+
+inline SpatialCollection::SpatialCollection(const std::string& name) : m_name(name)
+{
+}
+
+inline void SpatialCollection::insert(size_t rank, std::initializer_list<Element> args)
+{
+    Element grid("Grid", {{"Name", m_name + "_" + std::to_string(rank)}});
+
+    for (auto& arg : args) {
+        grid.push_back(arg);
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    XDMFWRITE_HIGHFIVE_CHECK(m_data.count(rank) == 0);
+    m_data.emplace(rank, std::move(grid));
+}
+
+inline size_t SpatialCollection::size() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_data.size();
+}
+
+inline Element SpatialCollection::get() const
+{
+    Element ret("Grid", {
+        {"CollectionType", "Spatial"},
+        {"GridType", "Collection"},
+        {"Name", m_name}});
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    for (auto& item : m_data) {
+        ret.push_back(item.second);
+    }
+
+    return ret;
+}
+
+inline Element Increment(const Element& grid)
+{
+    XDMFWRITE_HIGHFIVE_CHECK(detail::is_grid(grid));
+    Element ret("Increment");
+    ret.push_back(grid);
+    return ret;
+}
+
+#ifdef XDMFWRITE_HIGHFIVE_USE_MPI
+inline void SpatialCollection::gather(MPI_Comm comm, int root)
+{
+    int rank;
+    int size;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+
+    std::string buffer;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        buffer = detail::serialize(m_data);
+    }
+
+    // the number of characters is gathered without overflow,
+    // the total has to fit in an int to use MPI_Gatherv (checked on all ranks)
+    unsigned long long n = buffer.size();
+    std::vector<unsigned long long> sizes(size);
+
+    MPI_Gather(&n, 1, MPI_UNSIGNED_LONG_LONG, sizes.data(), 1, MPI_UNSIGNED_LONG_LONG, root, comm);
+
+    std::vector<int> count(size);
+    std::vector<int> displ(size, 0);
+    std::string recv;
+    int fits = 1;
+
+    if (rank == root) {
+        unsigned long long total = 0;
+        for (int i = 0; i < size; ++i) {
+            total += sizes[i];
+        }
+        fits = total <= static_cast<unsigned long long>((std::numeric_limits<int>::max)()) ? 1 : 0;
+        if (fits) {
+            for (int i = 0; i < size; ++i) {
+                count[i] = static_cast<int>(sizes[i]);
+                displ[i] = i > 0 ? displ[i - 1] + count[i - 1] : 0;
+            }
+            recv.resize(static_cast<size_t>(total));
+        }
+    }
+
+    MPI_Bcast(&fits, 1, MPI_INT, root, comm);
+
+    if (!fits) {
+        throw XDMFWRITE_HIGHFIVE_THROW("Too much data to gather");
+    }
+
+    MPI_Gatherv(
+        const_cast<char*>(buffer.data()), static_cast<int>(n), MPI_CHAR,
+        &recv[0], count.data(), displ.data(), MPI_CHAR,
+        root, comm);
+
+    if (rank == root) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        detail::deserialize(recv, m_data);
+    }
+}
+#endif
+
+inline TimeSeries::TimeSeries(const std::string& name) : m_name(name)
+{
+}
+
+template <class T>
+inline void TimeSeries::push_back(
+    const std::string& name,
+    const T& time,
+    std::initializer_list<Element> args)
+{
+    return this->push_back(name, time, std::vector<Element>(args));
+}
+
+template <class T>
+inline void TimeSeries::push_back(
+    const std::string& name,
+    const T& time,
+    std::vector<Element>&& args)
+{
+    if (m_n == 0 || m_reference.tag().size() == 0) {
+        detail::encode(detail::increment(name, detail::to<T>::str(time), m_shared, std::move(args)), m_strings, m_data);
+    }
+    else {
+        detail::encode(detail::increment(name, detail::to<T>::str(time), m_reference, std::move(args)), m_strings, m_data);
+    }
+    m_n++;
+}
+
+template <class T>
+inline void TimeSeries::push_back(
+    const T& time,
+    std::initializer_list<Element> args)
+{
+    return this->push_back("Increment " + std::to_string(m_n), time, args);
+}
+
+template <class T>
+inline void TimeSeries::push_back(
+    const T& time,
+    std::vector<Element>&& args)
+{
+    return this->push_back("Increment " + std::to_string(m_n), time, std::move(args));
+}
+
+inline void TimeSeries::push_back(
+    std::initializer_list<Element> args)
+{
+    return this->push_back("Increment " + std::to_string(m_n), m_n, args);
+}
+
+inline void TimeSeries::push_back(
+    std::vector<Element>&& args)
+{
+    return this->push_back("Increment " + std::to_string(m_n), m_n, std::move(args));
+}
+
+inline void TimeSeries::set_shared(std::initializer_list<Element> args)
+{
+    XDMFWRITE_HIGHFIVE_CHECK(m_n == 0);
+    m_shared = concatenate(args);
+    size_t n = detail::number_of_elements(m_shared);
+    m_reference = n > 0 ? detail::reference(m_name, n) : Element();
+}
+
+template <class S>
+inline void TimeSeries::render(S& sink, size_t depth) const
+{
+    Element collection = detail::collection(m_name);
+    detail::render_open(sink, collection, depth);
+    for (size_t i = 0; i < m_data.size();) {
+        detail::render(sink, detail::decode(m_data, i, m_strings), depth + 1);
+    }
+    detail::render_close(sink, collection, depth);
+}
+
+inline std::vector<std::string> TimeSeries::get() const
+{
+    std::vector<std::string> ret;
+    detail::lines_sink sink(ret);
+    this->render(sink, 0);
+    return ret;
+}
+
+template <class T>
+inline TimeSeries Discover(
     const HighFive::File& file,
     const std::string& dataset_geometry,
     const std::string& dataset_topology,
-    const T& type);
+    const T& type,
+    const std::string& pattern,
+    const std::string& dataset_time,
+    const std::map<std::string, AttributeCenter>& centers)
+{
+    MetadataCache cache(file);
+    cache.prefetch();
+    return Discover(cache, dataset_geometry, dataset_topology, type, pattern, dataset_time, centers);
+}
 
-/**
-Get a complete XDMF-file, e.g. from Grid() or TimeSeries().
+namespace detail {
 
-\param arg The data (any of the XDMFWrite_HighFive-classes or a sequence of strings) to write.
-\return XDMF-file as string.
-*/
-template <class T>
-inline std::string write(const T& arg);
+    // Implementation of Discover(), "dataset_time" is only skipped (the time is given).
+    template <class T>
+    inline TimeSeries discover(
+        MetadataCache& cache,
+        const std::string& dataset_geometry,
+        const std::string& dataset_topology,
+        const T& type,
+        const std::string& pattern,
+        const std::string& dataset_time,
+        const std::vector<double>& time,
+        const std::map<std::string, AttributeCenter>& centers)
+    {
+        size_t nnodes = cache.get(dataset_geometry).shape[0];
+        size_t nelem = cache.get(dataset_topology).shape[0];
 
-/**
-Write a complete XDMF-file, e.g. from Grid() or TimeSeries().
+        std::regex regex(pattern);
+        std::map<size_t, std::vector<Element>> increments;
 
-\param filename The filename to write to (file is overwritten).
-\param arg The data (any of the XDMFWrite_HighFive-classes or a sequence of strings) to write.
-\return XDMF-file as string.
-*/
-template <class T>
-inline std::string write(const std::string& filename, const T& arg);
+        for (auto& path : cache.datasets()) {
+            std::smatch match;
+            if (!std::regex_match(path, match, regex) || match.size() != 3) {
+                continue;
+            }
+            if (path == dataset_geometry || path == dataset_topology || path == dataset_time) {
+                continue;
+            }
 
-// --- Implementation ---
+            const Metadata& data = cache.get(path);
+            std::string name = match[1].str();
+            size_t n = data.shape.size() > 0 ? data.shape[0] : 0;
+            AttributeCenter center;
+            auto it = centers.find(name);
+
+            if (it != centers.end()) {
+                center = it->second;
+                if (n != (center == AttributeCenter::Node ? nnodes : nelem)) {
+                    continue;
+                }
+            }
+            else if (n == nnodes && n == nelem) {
+                throw XDMFWRITE_HIGHFIVE_THROW("Number of nodes and elements equal: specify center");
+            }
+            else if (n == nnodes) {
+                center = AttributeCenter::Node;
+            }
+            else if (n == nelem) {
+                center = AttributeCenter::Cell;
+            }
+            else {
+                continue;
+            }
 
-namespace detail {
+            std::string index = match[2].str();
+            size_t inc = 0;
+
+            if (index.size() == 0) {
+                throw XDMFWRITE_HIGHFIVE_THROW("Increment of DataSet is not an unsigned integer");
+            }
+
+            for (auto c : index) {
+                if (!std::isdigit(static_cast<unsigned char>(c)) ||
+                    inc > ((std::numeric_limits<size_t>::max)() - 9) / 10) {
+                    throw XDMFWRITE_HIGHFIVE_THROW("Increment of DataSet is not an unsigned integer");
+                }
+                inc = 10 * inc + static_cast<size_t>(c - '0');
+            }
+
+            increments[inc].push_back(Attribute(data, center, name));
+        }
+
+        TimeSeries ret;
+        ret.set_shared({Unstructured(cache, dataset_geometry, dataset_topology, type)});
+
+        for (auto& item : increments) {
+            std::string name = "Increment " + std::to_string(item.first);
+            if (time.size() > 0) {
+                XDMFWRITE_HIGHFIVE_CHECK(item.first < time.size());
+                ret.push_back(name, time[item.first], std::move(item.second));
+            }
+            else {
+                ret.push_back(name, item.first, std::move(item.second));
+            }
+        }
 
-    inline std::string unquote(const std::string& arg)
-    {
-        std::string ret = arg;
-        ret.erase(std::remove(ret.begin(), ret.end(), '\"'), ret.end());
         return ret;
     }
 
-}
+} // namespace detail
 
-inline std::string version()
+template <class T>
+inline TimeSeries Discover(
+    MetadataCache& cache,
+    const std::string& dataset_geometry,
+    const std::string& dataset_topology,
+    const T& type,
+    const std::string& pattern,
+    const std::string& dataset_time,
+    const std::map<std::string, AttributeCenter>& centers)
 {
-    return detail::unquote(std::string(QUOTE(XDMFWRITE_HIGHFIVE_VERSION)));
+    std::vector<double> time;
+
+    if (dataset_time.size() > 0) {
+        cache.file().getDataSet(dataset_time).read(time);
+    }
+
+    return detail::discover(
+        cache, dataset_geometry, dataset_topology, type, pattern, dataset_time, time, centers);
 }
 
-namespace detail {
+template <class T>
+inline TimeSeries Discover(
+    MetadataCache& cache,
+    const std::string& dataset_geometry,
+    const std::string& dataset_topology,
+    const T& type,
+    const std::string& pattern,
+    const std::vector<double>& time,
+    const std::map<std::string, AttributeCenter>& centers)
+{
+    return detail::discover(
+        cache, dataset_geometry, dataset_topology, type, pattern, "", time, centers);
+}
 
-    // SFINAE helper: check if a template argument is a string
-    template <class T>
-    struct is_string : std::false_type
-    {
-    };
+inline TimeSeries Resume(const std::string& filename)
+{
+    std::string name;
+    Element shared;
+    Element reference;
+    std::vector<Element> increments = detail::increments(filename, name, shared, reference);
 
-    template <>
-    struct is_string<std::string> : std::true_type
-    {
-    };
+    TimeSeries ret;
+    detail::access::restore(ret, name, shared, reference, increments);
+    return ret;
+}
 
-    // SFINAE helper: check if a template argument is a list of strings
-    template <class T>
-    struct is_string_list : std::false_type
-    {
-    };
+inline TimeSeries Resume(const std::string& filename, const HighFive::File& file)
+{
+    std::string name;
+    Element shared;
+    Element reference;
+    std::vector<Element> increments = detail::increments(filename, name, shared, reference);
 
-    template <>
-    struct is_string_list<std::vector<std::string>> : std::true_type
-    {
-    };
+    while (increments.size() > 0 && !detail::datasets_exist(increments.back(), file)) {
+        increments.pop_back();
+    }
 
-    // SFINAE helper: check if a template argument is an ElementType enum-class.
-    template <class T>
-    struct is_ElementType : std::false_type
-    {
-    };
+    TimeSeries ret;
+    detail::access::restore(ret, name, shared, reference, increments);
+    return ret;
+}
 
-    template <>
-    struct is_ElementType<ElementType> : std::true_type
-    {
-    };
+inline ConcurrentTimeSeries::ConcurrentTimeSeries() : ConcurrentTimeSeries("TimeSeries")
+{
+}
 
-    // SFINAE helper: check if a template argument is an AttributeCenter enum-class.
-    template <class T>
-    struct is_AttributeCenter : std::false_type
-    {
-    };
+inline ConcurrentTimeSeries::ConcurrentTimeSeries(const std::string& name, size_t shards)
+    : m_sequence(new std::atomic<size_t>(0)), m_name(name)
+{
+    if (shards == 0) {
+        shards = (std::max)(std::thread::hardware_concurrency(), 1u);
+    }
 
-    template <>
-    struct is_AttributeCenter<AttributeCenter> : std::true_type
-    {
-    };
+    for (size_t i = 0; i < shards; ++i) {
+        m_shards.emplace_back(new detail::concurrent_shard);
+    }
+}
 
-    // SFINAE helper: check if a template argument is an GooseFEM-ElementType enum-class.
-    #ifdef XDMFWRITE_HIGHFIVE_USE_GOOSEFEM
-    template <class T>
-    struct is_GooseFEM_ElementType : std::false_type
-    {
-    };
+template <class T>
+inline void ConcurrentTimeSeries::push_back(
+    const std::string& name,
+    const T& time,
+    std::initializer_list<Element> args)
+{
+    return this->push_back(name, time, std::vector<Element>(args));
+}
 
-    template <>
-    struct is_GooseFEM_ElementType<GooseFEM::Mesh::ElementType> : std::true_type
-    {
-    };
-    #endif
+template <class T>
+inline void ConcurrentTimeSeries::push_back(
+    const std::string& name,
+    const T& time,
+    std::vector<Element>&& args)
+{
+    return this->add(0, name, time, std::move(args));
+}
 
-    // Convert object to string
-    template <class T, typename = void>
-    struct to
-    {
-        static std::string str(const T& arg)
-        {
-            return std::to_string(arg);
-        }
-    };
+template <class T>
+inline void ConcurrentTimeSeries::insert(
+    size_t step,
+    const T& time,
+    std::initializer_list<Element> args)
+{
+    return this->add(step, "", time, std::vector<Element>(args));
+}
 
-    template <class T>
-    struct to<T, typename std::enable_if_t<is_string<T>::value>>
-    {
-        static std::string str(const T& arg)
-        {
-            return arg;
-        }
-    };
+template <class T>
+inline void ConcurrentTimeSeries::insert(
+    size_t step,
+    const T& time,
+    std::vector<Element>&& args)
+{
+    return this->add(step, "", time, std::move(args));
+}
 
-    template <class T>
-    struct to<T, typename std::enable_if_t<is_ElementType<T>::value>>
-    {
-        static std::string str(const T& arg)
-        {
-            if (arg == ElementType::Polyvertex) {
-                return "Polyvertex";
-            }
-            else if (arg == ElementType::Triangle) {
-                return "Triangle";
-            }
-            else if (arg == ElementType::Quadrilateral) {
-                return "Quadrilateral";
-            }
-            else if (arg == ElementType::Hexahedron) {
-                return "Hexahedron";
-            }
-            throw XDMFWRITE_HIGHFIVE_THROW("Unknown ElementType");
-        }
+template <class T>
+inline void ConcurrentTimeSeries::add(
+    size_t step,
+    const std::string& name,
+    const T& time,
+    std::vector<Element>&& args)
+{
+    static_assert(
+        std::is_arithmetic<T>::value,
+        "ConcurrentTimeSeries: the time has to be numeric (it is used to sort the increments)");
 
-        static ElementType type(const T& arg)
-        {
-            return arg;
-        }
-    };
+    double value = static_cast<double>(time);
+    XDMFWRITE_HIGHFIVE_CHECK(!std::isnan(value));
 
-    #ifdef XDMFWRITE_HIGHFIVE_USE_GOOSEFEM
-    template <class T>
-    struct to<T, typename std::enable_if_t<is_GooseFEM_ElementType<T>::value>>
-    {
-        static std::string str(const T& arg)
-        {
-            if (arg == GooseFEM::Mesh::ElementType::Tri3) {
-                return "Triangle";
-            }
-            else if (arg == GooseFEM::Mesh::ElementType::Quad4) {
-                return "Quadrilateral";
-            }
-            else if (arg == GooseFEM::Mesh::ElementType::Hex8) {
-                return "Hexahedron";
-            }
-            throw XDMFWRITE_HIGHFIVE_THROW("Unknown ElementType");
-        }
+    detail::concurrent_shard& shard = *m_shards[detail::thread_slot() % m_shards.size()];
 
-        static ElementType type(const T& arg)
-        {
-            if (arg == GooseFEM::Mesh::ElementType::Tri3) {
-                return ElementType::Triangle;
-            }
-            else if (arg == GooseFEM::Mesh::ElementType::Quad4) {
-                return ElementType::Quadrilateral;
-            }
-            else if (arg == GooseFEM::Mesh::ElementType::Hex8) {
-                return ElementType::Hexahedron;
-            }
-            throw XDMFWRITE_HIGHFIVE_THROW("Unknown ElementType");
-        }
-    };
-    #endif
+    std::lock_guard<std::mutex> lock(shard.mutex);
 
-    template <class T>
-    struct to<T, typename std::enable_if_t<is_AttributeCenter<T>::value>>
-    {
-        static std::string str(const T& arg)
-        {
-            if (arg == AttributeCenter::Cell) {
-                return "Cell";
-            }
-            else if (arg == AttributeCenter::Node) {
-                return "Node";
-            }
-            throw XDMFWRITE_HIGHFIVE_THROW("Unknown AttributeType");
-        }
-    };
+    detail::concurrent_shard::record record;
+    record.step = step;
+    record.time = value;
+    record.sequence = m_sequence->fetch_add(1);
+    record.time_str = shard.strings.intern(detail::to<T>::str(time));
+    record.name = shard.strings.intern(name);
+    record.offset = shard.data.size();
+    record.n = args.size();
 
-    template <class T>
-    inline std::string join_as_string(const std::vector<T>& arg, std::string sep)
-    {
-        std::vector<std::string> ret;
-        for (auto& i : arg) {
-            ret.push_back(to<T>::str(i));
-        }
-        return join(ret, sep);
+    for (auto& arg : args) {
+        detail::encode(arg, shard.strings, shard.data);
     }
 
-    template <class T, typename = void>
-    struct convert
-    {
-        static auto get(const T& arg)
-        {
-            return arg.get();
-        }
-    };
+    shard.records.push_back(record);
+}
+
+template <class T>
+inline void ConcurrentTimeSeries::push_back(
+    const T& time,
+    std::initializer_list<Element> args)
+{
+    return this->push_back("", time, std::vector<Element>(args));
+}
+
+template <class T>
+inline void ConcurrentTimeSeries::push_back(
+    const T& time,
+    std::vector<Element>&& args)
+{
+    return this->push_back("", time, std::move(args));
+}
+
+inline void ConcurrentTimeSeries::set_shared(std::initializer_list<Element> args)
+{
+    XDMFWRITE_HIGHFIVE_CHECK(this->size() == 0);
+    m_shared = concatenate(args);
+    size_t n = detail::number_of_elements(m_shared);
+    m_reference = n > 0 ? detail::reference(m_name, n) : Element();
+}
 
-    template <class T>
-    struct convert<T, typename std::enable_if_t<is_string_list<T>::value>>
-    {
-        static auto get(const T& arg)
-        {
-            return arg;
-        }
-    };
+inline size_t ConcurrentTimeSeries::size() const
+{
+    size_t n = 0;
+    for (auto& shard : m_shards) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        n += shard->records.size();
+    }
+    return n;
+}
 
-    template <class T, class E>
-    inline bool check_shape(const T& shape, E type)
-    {
-        auto t = detail::to<E>::type(type);
+template <class S>
+inline void ConcurrentTimeSeries::render(S& sink, size_t depth) const
+{
+    using record = detail::concurrent_shard::record;
 
-        if (shape.size() == 1 && t == ElementType::Polyvertex) {
-            return true;
-        }
-        if (shape.size() != 2) {
-            return false;
-        }
-        if (shape[1] == 3 && t == ElementType::Triangle) {
-            return true;
-        }
-        if (shape[1] == 4 && t == ElementType::Quadrilateral) {
-            return true;
-        }
-        if (shape[1] == 8 && t == ElementType::Hexahedron) {
-            return true;
+    std::vector<std::pair<const detail::concurrent_shard*, const record*>> order;
+
+    for (auto& shard : m_shards) {
+        for (auto& item : shard->records) {
+            order.emplace_back(shard.get(), &item);
         }
-        return false;
     }
 
-    inline std::string indent()
+    std::sort(order.begin(), order.end(), [](
+        const std::pair<const detail::concurrent_shard*, const record*>& a,
+        const std::pair<const detail::concurrent_shard*, const record*>& b)
     {
-        std::string ret = "";
-        if (XDMFWRITE_HIGHFIVE_INDENT == 0) {
-            return ret;
+        if (a.second->step != b.second->step) {
+            return a.second->step < b.second->step;
         }
-        for (size_t i = 0; i < XDMFWRITE_HIGHFIVE_INDENT; ++i) {
-            ret += " ";
+        if (a.second->time != b.second->time) {
+            return a.second->time < b.second->time;
         }
-        return ret;
-    }
+        return a.second->sequence < b.second->sequence;
+    });
 
-    inline std::string indent(size_t n)
-    {
-        std::string ret;
-        std::string i = indent();
-        for (size_t j = 0; j < n; ++j) {
-            ret += i;
-        }
-        return ret;
-    }
+    Element collection = detail::collection(m_name);
+    detail::render_open(sink, collection, depth);
 
-    inline void indent(std::vector<std::string>& lines)
-    {
-        auto i = indent();
-        for (auto& line : lines) {
-            line = i + line;
-        }
-    }
+    for (size_t inc = 0; inc < order.size(); ++inc) {
+        const detail::concurrent_shard& shard = *order[inc].first;
+        const record& item = *order[inc].second;
 
-    inline void indent(std::vector<std::string>& lines, size_t start, size_t stop)
-    {
-        auto i = indent();
-        for (size_t j = start; j < stop; ++j) {
-            lines[j] = i + lines[j];
+        std::string name = shard.strings[item.name];
+        if (name.size() == 0) {
+            name = "Increment " + std::to_string(inc);
         }
-    }
 
-    inline void indent(size_t n, std::vector<std::string>& lines)
-    {
-        auto i = indent(n);
-        for (auto& line : lines) {
-            line = i + line;
+        std::vector<Element> args;
+        size_t i = item.offset;
+        for (size_t j = 0; j < item.n; ++j) {
+            args.push_back(detail::decode(shard.data, i, shard.strings));
         }
-    }
 
-    inline void indent(size_t n, std::vector<std::string>& lines, size_t start, size_t stop)
-    {
-        auto i = indent(n);
-        for (size_t j = start; j < stop; ++j) {
-            lines[j] = i + lines[j];
-        }
+        const Element& shared = (inc == 0 || m_reference.tag().size() == 0) ? m_shared : m_reference;
+        detail::render(sink, detail::increment(name, shard.strings[item.time_str], shared, std::move(args)), depth + 1);
     }
 
-} // namespace detail
+    detail::render_close(sink, collection, depth);
+}
 
-inline std::string join(const std::vector<std::string>& lines, const std::string& sep)
+inline std::vector<std::string> ConcurrentTimeSeries::get() const
 {
-    if (lines.size() == 1) {
-        return lines[0];
-    }
+    std::vector<std::string> ret;
+    detail::lines_sink sink(ret);
+    this->render(sink, 0);
+    return ret;
+}
 
-    std::string ret = "";
+inline StreamingTimeSeries::StreamingTimeSeries(const std::string& filename)
+    : StreamingTimeSeries(filename, "TimeSeries")
+{
+}
 
-    for (auto line : lines) {
-        if (ret.size() == 0) {
-            ret += line;
-            continue;
-        }
+inline StreamingTimeSeries::StreamingTimeSeries(
+    const std::string& filename,
+    const std::string& name) : m_name(name)
+{
+    m_file.open(filename, std::ios::out | std::ios::trunc);
 
-        if (line[0] == sep[0]) {
-            ret += line;
-        }
-        else if (ret[ret.size() - 1] == sep[0]) {
-            ret += line;
-        }
-        else {
-            ret += sep + line;
-        }
+    if (!m_file.is_open()) {
+        throw XDMFWRITE_HIGHFIVE_THROW("Unable to open file");
     }
 
-    return ret;
+    detail::stream_sink sink(m_file);
+    detail::render_open(sink, detail::document(), 0);
+    detail::render_open(sink, Element("Domain"), 1);
+    detail::render_open(sink, detail::collection(m_name), 2);
+
+    this->write_tail();
 }
 
 template <class T>
-inline std::vector<T> concatenate(std::initializer_list<std::vector<T>> args)
+inline void StreamingTimeSeries::push_back(
+    const std::string& name,
+    const T& time,
+    std::initializer_list<Element> args)
 {
-    size_t n = 0;
-    for (auto& arg : args) {
-        n += arg.size();
-    }
-    std::vector<T> ret;
-    ret.reserve(n);
-    for (auto& arg : args) {
-        ret.insert(ret.end(), arg.begin(), arg.end());
-    }
-    return ret;
+    return this->push_back(name, time, std::vector<Element>(args));
 }
 
-inline std::vector<std::string> Geometry(
-    const HighFive::File& file,
-    const std::string& dataset)
+template <class T>
+inline void StreamingTimeSeries::push_back(
+    const std::string& name,
+    const T& time,
+    std::vector<Element>&& args)
 {
-    std::vector<std::string> ret;
-    auto shape = H5Easy::getShape(file, dataset);
-    auto fname = file.getName();
+    m_file.seekp(m_tail);
 
-    XDMFWRITE_HIGHFIVE_ASSERT(shape.size() == 2);
+    detail::stream_sink sink(m_file);
 
-    if (shape[1] == 1) {
-        ret.push_back("<Geometry GeometryType=\"X\">");
-    }
-    else if (shape[1] == 2) {
-        ret.push_back("<Geometry GeometryType=\"XY\">");
-    }
-    else if (shape[1] == 3) {
-        ret.push_back("<Geometry GeometryType=\"XYZ\">");
+    if (m_n == 0 || m_reference.tag().size() == 0) {
+        detail::render(sink, detail::increment(name, detail::to<T>::str(time), m_shared, std::move(args)), 3);
     }
     else {
-        throw XDMFWRITE_HIGHFIVE_THROW("Illegal number of dimensions.");
+        detail::render(sink, detail::increment(name, detail::to<T>::str(time), m_reference, std::move(args)), 3);
     }
 
-    ret.push_back(
-        detail::indent() + "<DataItem Dimensions=\"" + std::to_string(shape[0]) + " " +
-        std::to_string(shape[1]) + "\" Format=\"HDF\">" + fname + ":" + dataset +
-        "</DataItem>");
+    this->write_tail();
 
-    ret.push_back("</Geometry>");
-
-    return ret;
+    m_n++;
 }
 
 template <class T>
-inline std::vector<std::string> Topology(
-    const HighFive::File& file,
-    const std::string& dataset,
-    const T& type)
+inline void StreamingTimeSeries::push_back(
+    const T& time,
+    std::initializer_list<Element> args)
 {
-    std::vector<std::string> ret;
-    auto shape = H5Easy::getShape(file, dataset);
-    auto fname = file.getName();
-
-    XDMFWRITE_HIGHFIVE_ASSERT(detail::check_shape(shape, type));
+    return this->push_back("Increment " + std::to_string(m_n), time, args);
+}
 
-    ret.push_back(
-        "<Topology NumberOfElements=\"" + std::to_string(shape[0]) + "\" TopologyType=\"" +
-        detail::to<T>::str(type) + "\">");
+template <class T>
+inline void StreamingTimeSeries::push_back(
+    const T& time,
+    std::vector<Element>&& args)
+{
+    return this->push_back("Increment " + std::to_string(m_n), time, std::move(args));
+}
 
-    ret.push_back(
-        detail::indent() + "<DataItem Dimensions=\"" + detail::join_as_string(shape, " ") +
-        "\" Format=\"HDF\">" + fname + ":" + dataset +
-        "</DataItem>");
+inline void StreamingTimeSeries::push_back(
+    std::initializer_list<Element> args)
+{
+    return this->push_back("Increment " + std::to_string(m_n), m_n, args);
+}
 
-    ret.push_back("</Topology>");
+inline void StreamingTimeSeries::push_back(
+    std::vector<Element>&& args)
+{
+    return this->push_back("Increment " + std::to_string(m_n), m_n, std::move(args));
+}
 
-    return ret;
+inline void StreamingTimeSeries::set_shared(std::initializer_list<Element> args)
+{
+    XDMFWRITE_HIGHFIVE_CHECK(m_n == 0);
+    m_shared = concatenate(args);
+    size_t n = detail::number_of_elements(m_shared);
+    m_reference = n > 0 ? detail::reference(m_name, n) : Element();
 }
 
-inline std::vector<std::string> Structured(
-    const HighFive::File& file,
-    const std::string& dataset_geometry,
-    const std::string& dataset_topology)
+inline void StreamingTimeSeries::write_tail()
 {
-    auto shape_geometry = H5Easy::getShape(file, dataset_geometry);
-    auto shape_topology = H5Easy::getShape(file, dataset_topology);
+    m_tail = m_file.tellp();
 
-    XDMFWRITE_HIGHFIVE_ASSERT(shape_geometry[0] == shape_topology[0]);
+    detail::stream_sink sink(m_file);
+    detail::render_close(sink, detail::collection(m_name), 2);
+    detail::render_close(sink, Element("Domain"), 1);
+    detail::render_close(sink, detail::document(), 0);
 
-    return concatenate({
-        Geometry(file, dataset_geometry),
-        Topology(file, dataset_topology, ElementType::Polyvertex)});
+    m_file.flush();
 }
 
-template <class T>
-inline std::vector<std::string> Unstructured(
-    const HighFive::File& file,
-    const std::string& dataset_geometry,
-    const std::string& dataset_topology,
-    const T& type)
+inline void StreamingTimeSeries::close()
 {
-    return concatenate({
-        Geometry(file, dataset_geometry),
-        Topology(file, dataset_topology, type)});
+    m_file.close();
 }
 
 template <class T>
-inline std::vector<std::string> Attribute(
-    const HighFive::File& file,
-    const std::string& dataset,
-    const T& center,
-    const std::string &name)
+inline std::string write(const T& arg)
 {
-    std::vector<std::string> ret;
-    auto shape = H5Easy::getShape(file, dataset);
-    auto fname = file.getName();
-
-    XDMFWRITE_HIGHFIVE_ASSERT(shape.size() > 0);
-    XDMFWRITE_HIGHFIVE_ASSERT(shape.size() < 3);
+    std::ostringstream stream;
+    write(stream, arg);
+    std::string ret = stream.str();
+    ret.pop_back(); // trailing newline
+    return ret;
+}
 
-    std::string t;
-    if (shape.size() == 1) {
-        t = "Scalar";
-    }
-    else if (shape.size() == 2) {
-        t = "Vector";
-    }
-    else {
-        throw XDMFWRITE_HIGHFIVE_THROW("Type of data cannot be deduced");
-    }
+template <class T>
+inline void write(std::ostream& stream, const T& arg)
+{
+    detail::stream_sink sink(stream);
+    detail::render_document(sink, arg);
+}
 
-    ret.push_back(
-        "<Attribute AttributeType=\"" + t + "\" Center=\"" + detail::to<T>::str(center) +
-        "\" Name=\"" + name + "\">");
+template <class It, class T, typename>
+inline It write(It out, const T& arg)
+{
+    detail::iterator_sink<It> sink(out);
+    detail::render_document(sink, arg);
+    return sink.out();
+}
 
-    ret.push_back(
-        detail::indent() + "<DataItem Dimensions=\"" + detail::join_as_string(shape, " ") +
-        "\" Format=\"HDF\">" + fname + ":" + dataset + "</DataItem>");
+template <class T>
+inline void write(const std::string& fname, const T& arg)
+{
+    std::ofstream myfile;
+    myfile.open(fname);
 
-    ret.push_back("</Attribute>");
+    if (!myfile.is_open()) {
+        throw XDMFWRITE_HIGHFIVE_THROW("Unable to open file");
+    }
 
-    return ret;
+    write(myfile, arg);
+    myfile.close();
 }
 
-template <class T>
-inline std::vector<std::string> Attribute(
-    const HighFive::File& file,
-    const std::string& dataset,
-    const T& center)
+inline AsyncWriter::AsyncWriter(size_t capacity) : m_capacity((std::max)(capacity, size_t(1)))
 {
-    return Attribute(file, dataset, center, dataset);
+    m_thread = std::thread(&AsyncWriter::run, this);
 }
 
-inline std::vector<std::string> Grid(
-    const std::string& name,
-    std::initializer_list<std::vector<std::string>> args)
+inline AsyncWriter::~AsyncWriter()
 {
-    std::vector<std::string> ret;
-    ret.push_back(
-        "<Grid CollectionType=\"Temporal\" GridType=\"Collection\" Name=\"" + name + "\">");
-    ret.push_back("<Grid Name=\"" + name + "\">");
-    for (auto& arg : args) {
-        ret.insert(ret.end(), arg.begin(), arg.end());
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_stop = true;
     }
-    ret.push_back("</Grid>");
-    ret.push_back("</Grid>");
-    detail::indent(2, ret, 2, ret.size() - 2);
-    return ret;
+    m_cond.notify_all();
+    m_thread.join();
 }
 
-inline std::vector<std::string> Grid(std::initializer_list<std::vector<std::string>> args)
+template <class T>
+inline void AsyncWriter::write(const std::string& filename, T&& arg)
 {
-    return Grid("Grid", args);
+    using is_series = std::integral_constant<
+        bool,
+        std::is_same<typename std::decay<T>::type, TimeSeries>::value &&
+            std::is_lvalue_reference<T>::value>;
+
+    this->enqueue(this->snapshot(filename, std::forward<T>(arg), is_series()));
 }
 
-inline TimeSeries::TimeSeries(const std::string& name) : m_name(name)
+template <class T>
+inline AsyncWriter::job AsyncWriter::snapshot(const std::string& filename, T&& arg, std::false_type)
 {
+    auto data = std::make_shared<const typename std::decay<T>::type>(std::forward<T>(arg));
+
+    job item;
+    item.filename = filename;
+    item.render = [data](std::ostream& stream) { XDMFWrite_HighFive::write(stream, *data); };
+    return item;
 }
 
-template <class T>
-inline void TimeSeries::push_back(
-    const std::string& name,
-    const T& time,
-    std::initializer_list<std::vector<std::string>> args)
+inline AsyncWriter::job AsyncWriter::snapshot(const std::string& filename, const TimeSeries& arg, std::true_type)
 {
-    m_lines.push_back("<Grid Name=\"" + name + "\">");
-    m_lines.push_back(detail::indent() + "<Time Value=\"" + detail::to<T>::str(time) + "\"/>");
-    size_t start = m_lines.size();
-    for (auto& arg : args) {
-        m_lines.insert(m_lines.end(), arg.begin(), arg.end());
-    }
-    size_t stop = m_lines.size();
-    detail::indent(m_lines, start, stop);
-    m_lines.push_back("</Grid>");
-    m_n++;
+    job item;
+    item.filename = filename;
+    item.source = &arg;
+    return item;
 }
 
-template <class T>
-inline void TimeSeries::push_back(
-    const T& time,
-    std::initializer_list<std::vector<std::string>> args)
+inline void AsyncWriter::enqueue(job&& item)
 {
-    return this->push_back("Increment " + std::to_string(m_n), time, args);
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    // the queue is scanned again after waiting for room: a request for the same file
+    // may have been queued (by another thread) in the meantime
+    job* pending = nullptr;
+
+    while (true) {
+        this->rethrow();
+
+        for (auto& queued : m_queue) {
+            if (queued.filename == item.filename) {
+                pending = &queued;
+                break;
+            }
+        }
+
+        if (pending || m_queue.size() < m_capacity) {
+            break;
+        }
+
+        m_cond.wait(lock);
+    }
+
+    if (item.source) {
+        detail::access::diff(*item.source, m_cursor[item.filename], item.delta);
+        item.source = nullptr;
+    }
+    else {
+        m_cursor.erase(item.filename);
+    }
+
+    if (!pending) {
+        m_queue.push_back(std::move(item));
+        m_cond.notify_all();
+        return;
+    }
+
+    // coalesce: the increments added since the pending request are appended to it
+    if (!item.render && !item.delta.base) {
+        auto& delta = pending->delta;
+        delta.strings.insert(delta.strings.end(), item.delta.strings.begin(), item.delta.strings.end());
+        delta.data.insert(delta.data.end(), item.delta.data.begin(), item.delta.data.end());
+        delta.n = item.delta.n;
+        return;
+    }
+
+    *pending = std::move(item);
 }
 
-inline void TimeSeries::push_back(
-    std::initializer_list<std::vector<std::string>> args)
+inline void AsyncWriter::flush()
 {
-    return this->push_back("Increment " + std::to_string(m_n), m_n, args);
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_cond.wait(lock, [this]() { return (m_queue.empty() && !m_busy) || m_error; });
+    this->rethrow();
 }
 
-inline std::vector<std::string> TimeSeries::get() const
+inline size_t AsyncWriter::pending() const
 {
-    std::vector<std::string> ret;
-    ret.push_back(
-        "<Grid CollectionType=\"Temporal\" GridType=\"Collection\" Name=\"" + m_name + "\">");
-    ret.insert(ret.end(), m_lines.begin(), m_lines.end());
-    ret.push_back("</Grid>");
-    detail::indent(ret, 1, ret.size() - 1);
-    return ret;
+    std::unique_lock<std::mutex> lock(m_mutex);
+    return m_queue.size() + (m_busy ? 1 : 0);
 }
 
-template <class T>
-inline std::string write(const T& arg)
+inline void AsyncWriter::rethrow()
 {
-    std::vector<std::string> ret;
-    std::vector<std::string> lines = detail::convert<T>::get(arg);
-    ret.push_back("<Xdmf Version=\"3.0\">");
-    ret.push_back(detail::indent() + "<Domain>");
-    ret.insert(ret.end(), lines.begin(), lines.end());
-    ret.push_back(detail::indent() + "</Domain>");
-    ret.push_back("</Xdmf>");
-    detail::indent(2, ret, 2, ret.size() - 2);
-    return join(ret);
+    if (m_error) {
+        std::exception_ptr error = m_error;
+        m_error = nullptr;
+        std::rethrow_exception(error);
+    }
 }
 
-template <class T>
-inline std::string write(const std::string& fname, const T& arg)
+inline void AsyncWriter::run()
 {
-    auto ret = write(arg);
-    std::ofstream myfile;
-    myfile.open(fname);
-    myfile << ret << std::endl;
-    myfile.close();
-    return ret;
+    while (true) {
+
+        job item;
+
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cond.wait(lock, [this]() { return !m_queue.empty() || m_stop; });
+
+            if (m_queue.empty()) {
+                return;
+            }
+
+            item = std::move(m_queue.front());
+            m_queue.pop_front();
+            m_busy = true;
+        }
+
+        // room in the queue
+        m_cond.notify_all();
+
+        try {
+            std::string tmp = item.filename + ".tmp";
+            std::ofstream file(tmp);
+
+            if (!file.is_open()) {
+                throw XDMFWRITE_HIGHFIVE_THROW("Unable to open file");
+            }
+
+            if (item.render) {
+                m_series.erase(item.filename);
+                item.render(file);
+            }
+            else {
+                auto& series = m_series[item.filename];
+                if (item.delta.base) {
+                    series = std::move(*item.delta.base);
+                }
+                detail::access::apply(series, item.delta);
+                XDMFWrite_HighFive::write(file, series);
+            }
+
+            file.close();
+
+            if (!file) {
+                throw XDMFWRITE_HIGHFIVE_THROW("Unable to write file");
+            }
+
+#ifdef _WIN32
+            // std::rename does not overwrite an existing file on Windows
+            if (!MoveFileExA(tmp.c_str(), item.filename.c_str(), MOVEFILE_REPLACE_EXISTING)) {
+                throw XDMFWRITE_HIGHFIVE_THROW("Unable to rename file");
+            }
+#else
+            if (std::rename(tmp.c_str(), item.filename.c_str()) != 0) {
+                throw XDMFWRITE_HIGHFIVE_THROW("Unable to rename file");
+            }
+#endif
+        }
+        catch (...) {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_error = std::current_exception();
+
+            // the copy of the TimeSeries may lack the increments of this request:
+            // the next write() of the file copies the TimeSeries completely,
+            // a waiting request with only new increments can no longer be applied
+            m_cursor.erase(item.filename);
+            m_series.erase(item.filename);
+            m_queue.erase(
+                std::remove_if(
+                    m_queue.begin(),
+                    m_queue.end(),
+                    [&](const job& queued) {
+                        return queued.filename == item.filename && !queued.render &&
+                               !queued.delta.base;
+                    }),
+                m_queue.end());
+        }
+
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_busy = false;
+        }
+
+        m_cond.notify_all();
+    }
 }
 
 } // namespace XDMFWrite_HighFive
@@ -3,12 +3,41 @@
 #include <catch2/catch.hpp>
 #include <GooseFEM/GooseFEM.h>
 #include <highfive/H5Easy.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <future>
+#include <limits>
+#include <locale>
+#include <numeric>
+#include <sstream>
+#include <thread>
 
 #define XDMFWRITE_HIGHFIVE_INDENT 0
 #include <XDMFWrite_HighFive.hpp>
 
 namespace xh = XDMFWrite_HighFive;
 
+// Data of which rendering blocks until it is released, to keep the thread of AsyncWriter busy.
+namespace XDMFWrite_HighFive {
+namespace detail {
+    struct blocking
+    {
+        std::shared_future<void> release;
+        std::shared_ptr<std::atomic<bool>> started;
+    };
+
+    template <class S>
+    inline void render(S& sink, const blocking& arg, size_t depth)
+    {
+        *arg.started = true;
+        arg.release.wait();
+        render(sink, Element("Grid"), depth);
+    }
+}
+}
+
 TEST_CASE("XDMFWrite_HighFive", "Basic")
 {
 
@@ -44,17 +73,946 @@ TEST_CASE("XDMFWrite_HighFive", "Basic")
 
         std::vector<std::string> t = {
             "<Topology NumberOfElements=\"9\" TopologyType=\"Quadrilateral\">",
-            "<DataItem Dimensions=\"9 4\" Format=\"HDF\">tmp.h5:/conn</DataItem>",
+            "<DataItem Dimensions=\"9 4\" Format=\"HDF\" NumberType=\"UInt\" Precision=\"8\">tmp.h5:/conn</DataItem>",
             "</Topology>"};
 
         std::vector<std::string> g = {
             "<Geometry GeometryType=\"XY\">",
-            "<DataItem Dimensions=\"16 2\" Format=\"HDF\">tmp.h5:/coor</DataItem>",
+            "<DataItem Dimensions=\"16 2\" Format=\"HDF\" NumberType=\"Float\" Precision=\"8\">tmp.h5:/coor</DataItem>",
             "</Geometry>"};
 
         REQUIRE(t == xh::Topology(file, "/conn", mesh.getElementType()));
         REQUIRE(g == xh::Geometry(file, "/coor"));
     }
-}
 
+    SECTION("Grid")
+    {
+        H5Easy::File file("tmp.h5", H5Easy::File::Overwrite);
+
+        GooseFEM::Mesh::Quad4::Regular mesh(3, 3);
+
+        H5Easy::dump(file, "/coor", mesh.coor());
+        H5Easy::dump(file, "/conn", mesh.conn());
+
+        std::vector<std::string> g = xh::Geometry(file, "/coor");
+
+        std::vector<std::string> grid = {
+            "<Grid CollectionType=\"Temporal\" GridType=\"Collection\" Name=\"Grid\">",
+            "<Grid Name=\"Grid\">",
+            "<Geometry GeometryType=\"XY\">",
+            "<DataItem Dimensions=\"16 2\" Format=\"HDF\" NumberType=\"Float\" Precision=\"8\">tmp.h5:/coor</DataItem>",
+            "</Geometry>",
+            "<Topology NumberOfElements=\"9\" TopologyType=\"Quadrilateral\">",
+            "<DataItem Dimensions=\"9 4\" Format=\"HDF\" NumberType=\"UInt\" Precision=\"8\">tmp.h5:/conn</DataItem>",
+            "</Topology>",
+            "</Grid>",
+            "</Grid>"};
+
+        REQUIRE(grid == xh::Grid({g, xh::Topology(file, "/conn", mesh.getElementType())}));
+    }
+
+    SECTION("write")
+    {
+        H5Easy::File file("tmp.h5", H5Easy::File::Overwrite);
+
+        GooseFEM::Mesh::Quad4::Regular mesh(3, 3);
+
+        H5Easy::dump(file, "/coor", mesh.coor());
+        H5Easy::dump(file, "/conn", mesh.conn());
+
+        auto grid = xh::Grid({xh::Unstructured(file, "/coor", "/conn", mesh.getElementType())});
+
+        std::vector<std::string> lines;
+        xh::write(std::back_inserter(lines), grid);
+        REQUIRE(xh::join(lines) == xh::write(grid));
+
+        std::ostringstream stream;
+        xh::write(stream, grid);
+        REQUIRE(stream.str() == xh::write(grid) + "\n");
+    }
+
+    SECTION("TimeSeries - shared")
+    {
+        H5Easy::File file("tmp.h5", H5Easy::File::Overwrite);
+
+        GooseFEM::Mesh::Quad4::Regular mesh(3, 3);
+
+        H5Easy::dump(file, "/coor", mesh.coor());
+        H5Easy::dump(file, "/conn", mesh.conn());
+        H5Easy::dump(file, "/disp", mesh.coor());
+
+        xh::TimeSeries series;
+        series.set_shared({xh::Unstructured(file, "/coor", "/conn", mesh.getElementType())});
+        series.push_back({xh::Attribute(file, "/disp", xh::AttributeCenter::Node)});
+        series.push_back({xh::Attribute(file, "/disp", xh::AttributeCenter::Node)});
+
+        std::vector<std::string> increment = {
+            "<Grid Name=\"Increment 1\">",
+            "<Time Value=\"1\"/>",
+            "<xi:include xpointer=\"xpointer(/Xdmf/Domain/Grid[@Name='TimeSeries']/Grid[1]/*[position()>1 and not(position()>3)])\"/>",
+            "<Attribute AttributeType=\"Vector\" Center=\"Node\" Name=\"/disp\">",
+            "<DataItem Dimensions=\"16 2\" Format=\"HDF\" NumberType=\"Float\" Precision=\"8\">tmp.h5:/disp</DataItem>",
+            "</Attribute>",
+            "</Grid>"};
+
+        auto lines = series.get();
+        REQUIRE(lines.size() == 1 + 12 + 7 + 1);
+        REQUIRE(std::vector<std::string>(lines.end() - 8, lines.end() - 1) == increment);
+    }
+
+    SECTION("StreamingTimeSeries")
+    {
+        H5Easy::File file("tmp.h5", H5Easy::File::Overwrite);
+
+        GooseFEM::Mesh::Quad4::Regular mesh(3, 3);
+
+        H5Easy::dump(file, "/coor", mesh.coor());
+        H5Easy::dump(file, "/conn", mesh.conn());
+
+        xh::TimeSeries series;
+        xh::StreamingTimeSeries stream("tmp_stream.xdmf");
+
+        for (size_t i = 0; i < 3; ++i) {
+            series.push_back({xh::Unstructured(file, "/coor", "/conn", mesh.getElementType())});
+            stream.push_back({xh::Unstructured(file, "/coor", "/conn", mesh.getElementType())});
+            std::ifstream written("tmp_stream.xdmf");
+            std::stringstream contents;
+            contents << written.rdbuf();
+            REQUIRE(contents.str() == xh::write(series) + "\n");
+        }
+    }
+
+    SECTION("MetadataCache")
+    {
+        H5Easy::File file("tmp.h5", H5Easy::File::Overwrite);
+
+        GooseFEM::Mesh::Quad4::Regular mesh(3, 3);
+
+        H5Easy::dump(file, "/coor", mesh.coor());
+        H5Easy::dump(file, "/conn", mesh.conn());
+        H5Easy::dump(file, "/data/stress", mesh.coor());
+
+        xh::MetadataCache cache(file);
+        cache.prefetch();
+
+        REQUIRE(cache.contains("/coor"));
+        REQUIRE(cache.contains("/conn"));
+        REQUIRE(cache.contains("/data/stress"));
+        REQUIRE(cache.get("/coor").shape == std::vector<size_t>{16, 2});
+        REQUIRE(cache.get("/coor").number_type == "Float");
+        REQUIRE(cache.get("/coor").precision == 8);
+
+        REQUIRE(xh::Unstructured(cache, "/coor", "/conn", mesh.getElementType()) ==
+                xh::Unstructured(file, "/coor", "/conn", mesh.getElementType()));
+        REQUIRE(xh::Attribute(cache, "/data/stress", xh::AttributeCenter::Node) ==
+                xh::Attribute(file, "/data/stress", xh::AttributeCenter::Node));
+
+        cache.invalidate("/coor");
+        REQUIRE(!cache.contains("/coor"));
+    }
+
+    SECTION("Shape-supplied")
+    {
+        H5Easy::File file("tmp.h5", H5Easy::File::Overwrite);
+
+        GooseFEM::Mesh::Quad4::Regular mesh(3, 3);
+
+        H5Easy::dump(file, "/coor", mesh.coor());
+        H5Easy::dump(file, "/conn", mesh.conn());
+
+        REQUIRE(xh::Geometry("tmp.h5", "/coor", mesh.coor()) == xh::Geometry(file, "/coor"));
+
+        std::vector<std::string> g = {
+            "<Geometry GeometryType=\"XY\">",
+            "<DataItem Dimensions=\"16 2\" Format=\"HDF\">tmp.h5:/coor</DataItem>",
+            "</Geometry>"};
+
+        REQUIRE(g == xh::Geometry("tmp.h5", "/coor", {16, 2}));
+        REQUIRE(xh::Topology("tmp.h5", "/conn", mesh.conn(), mesh.getElementType()) ==
+                xh::Topology(file, "/conn", mesh.getElementType()));
+        REQUIRE(xh::Attribute("tmp.h5", "/coor", mesh.coor(), xh::AttributeCenter::Node, "u") ==
+                xh::Attribute(file, "/coor", xh::AttributeCenter::Node, "u"));
+    }
+
+    SECTION("NumberType")
+    {
+        H5Easy::File file("tmp.h5", H5Easy::File::Overwrite);
+
+        H5Easy::dump(file, "/float", std::vector<float>{1.0, 2.0});
+        H5Easy::dump(file, "/int", std::vector<int>{1, 2});
+
+        std::vector<std::string> f = {
+            "<Attribute AttributeType=\"Scalar\" Center=\"Node\" Name=\"/float\">",
+            "<DataItem Dimensions=\"2\" Format=\"HDF\" NumberType=\"Float\" Precision=\"4\">tmp.h5:/float</DataItem>",
+            "</Attribute>"};
+
+        std::vector<std::string> i = {
+            "<Attribute AttributeType=\"Scalar\" Center=\"Cell\" Name=\"/int\">",
+            "<DataItem Dimensions=\"2\" Format=\"HDF\" NumberType=\"Int\" Precision=\"4\">tmp.h5:/int</DataItem>",
+            "</Attribute>"};
+
+        REQUIRE(f == xh::Attribute(file, "/float", xh::AttributeCenter::Node));
+        REQUIRE(i == xh::Attribute(file, "/int", xh::AttributeCenter::Cell));
+    }
+
+    SECTION("HyperSlab")
+    {
+        H5Easy::File file("tmp.h5", H5Easy::File::Overwrite);
+
+        H5Easy::dump(file, "/disp", std::vector<double>(3 * 16 * 2), {3, 16, 2});
+
+        std::vector<std::string> a = {
+            "<Attribute AttributeType=\"Vector\" Center=\"Node\" Name=\"u\">",
+            "<DataItem Dimensions=\"16 2\" ItemType=\"HyperSlab\">",
+            "<DataItem Dimensions=\"3 3\" Format=\"XML\">2 0 0 1 1 1 1 16 2</DataItem>",
+            "<DataItem Dimensions=\"3 16 2\" Format=\"HDF\" NumberType=\"Float\" Precision=\"8\">tmp.h5:/disp</DataItem>",
+            "</DataItem>",
+            "</Attribute>"};
+
+        xh::MetadataCache cache(file);
+
+        REQUIRE(a == xh::Attribute(file, "/disp", 2, xh::AttributeCenter::Node, "u"));
+        REQUIRE(a == xh::Attribute(cache, "/disp", 2, xh::AttributeCenter::Node, "u"));
+        xh::HyperSlab slab(cache.get("/disp"), {2, 0, 0}, {1, 1, 1}, {1, 16, 2}, {16, 2});
+        REQUIRE(a == xh::Attribute(slab, xh::AttributeCenter::Node, "u"));
+        REQUIRE(xh::Geometry(file, "/disp", 1) == xh::Geometry(cache, "/disp", 1));
+    }
+
+    SECTION("AppendableField")
+    {
+        H5Easy::File file("tmp.h5", H5Easy::File::Overwrite);
+
+        xh::AppendableField<double> disp(file, "/disp", {16, 2}, {}, 2);
+        std::vector<xh::HyperSlab> slabs;
+
+        for (size_t i = 0; i < 3; ++i) {
+            std::vector<double> u(16 * 2, static_cast<double>(i));
+            slabs.push_back(disp.append(u));
+        }
+
+        REQUIRE(H5Easy::getShape(file, "/disp") == std::vector<size_t>{4, 16, 2});
+        REQUIRE(disp.metadata().shape[0] == 3);
+
+        // reopen: the reserved room is not taken for data
+        {
+            xh::AppendableField<double> reopened(file, "/disp", {16, 2}, {}, 2);
+            REQUIRE(reopened.size() == 3);
+            REQUIRE(reopened.append(std::vector<double>(16 * 2, 3.0)).start[0] == 3);
+            REQUIRE(H5Easy::getShape(file, "/disp") == std::vector<size_t>{4, 16, 2});
+        }
+
+        xh::AppendableField<double> reopened(file, "/disp", {16, 2}, {}, 2);
+        REQUIRE(reopened.size() == 4);
+        reopened.append(std::vector<double>(16 * 2, 4.0));
+        reopened.shrink_to_fit();
+
+        // the selections written before remain within the DataSet
+        REQUIRE(reopened.size() == 5);
+        REQUIRE(H5Easy::getShape(file, "/disp") == std::vector<size_t>{5, 16, 2});
+        for (auto& slab : slabs) {
+            REQUIRE(slab.data.shape[0] <= 5);
+        }
+        REQUIRE(xh::Attribute(reopened.slab(2), xh::AttributeCenter::Node, "u") ==
+                xh::Attribute(file, "/disp", 2, xh::AttributeCenter::Node, "u"));
+
+        REQUIRE_THROWS(xh::AppendableField<double>(file, "/disp", {16, 2}, {}, 0));
+    }
+
+    SECTION("RaggedField")
+    {
+        H5Easy::File file("tmp.h5", H5Easy::File::Overwrite);
+
+        xh::RaggedField<double> coor(file, "/coor", {2});
+        xh::RaggedField<double> mass(file, "/mass");
+
+        coor.append(std::vector<double>(3 * 2));
+        mass.append(std::vector<double>(3));
+
+        std::vector<std::string> s = {
+            "<Geometry GeometryType=\"XY\">",
+            "<DataItem Dimensions=\"5 2\" ItemType=\"HyperSlab\">",
+            "<DataItem Dimensions=\"3 2\" Format=\"XML\">3 0 1 1 5 2</DataItem>",
+            "<DataItem Dimensions=\"8 2\" Format=\"HDF\" NumberType=\"Float\" Precision=\"8\">tmp.h5:/coor</DataItem>",
+            "</DataItem>",
+            "</Geometry>",
+            "<Topology NodesPerElement=\"1\" NumberOfElements=\"5\" TopologyType=\"Polyvertex\"/>"};
+
+        REQUIRE(s == xh::Structured(coor.append(std::vector<double>(5 * 2))));
+        REQUIRE(mass.append(std::vector<double>(5)).shape == std::vector<size_t>{5});
+        REQUIRE(H5Easy::getShape(file, "/mass") == std::vector<size_t>{8});
+        REQUIRE(H5Easy::getShape(file, "/coor_offsets") == std::vector<size_t>{3});
+
+        xh::RaggedField<double> reopened(file, "/coor", {2});
+        REQUIRE(reopened.size() == 2);
+        REQUIRE(reopened.slab(1).start == std::vector<size_t>{3, 0});
+    }
+
+    SECTION("Structured - without connectivity")
+    {
+        H5Easy::File file("tmp.h5", H5Easy::File::Overwrite);
+
+        GooseFEM::Mesh::Quad4::Regular mesh(3, 3);
+
+        H5Easy::dump(file, "/coor", mesh.coor());
+
+        std::vector<std::string> s = {
+            "<Geometry GeometryType=\"XY\">",
+            "<DataItem Dimensions=\"16 2\" Format=\"HDF\" NumberType=\"Float\" Precision=\"8\">tmp.h5:/coor</DataItem>",
+            "</Geometry>",
+            "<Topology NodesPerElement=\"1\" NumberOfElements=\"16\" TopologyType=\"Polyvertex\"/>"};
+
+        xh::MetadataCache cache(file);
+
+        REQUIRE(s == xh::Structured(file, "/coor"));
+        REQUIRE(s == xh::Structured(cache, "/coor"));
+        REQUIRE(s == xh::concatenate({xh::Geometry(file, "/coor"), xh::Topology(xh::ElementType::Polyvertex, 16)}));
+    }
+
+    SECTION("RegularGrid")
+    {
+        std::vector<std::string> r = {
+            "<Topology Dimensions=\"3 4\" TopologyType=\"2DCoRectMesh\"/>",
+            "<Geometry GeometryType=\"ORIGIN_DXDY\">",
+            "<DataItem Dimensions=\"2\" Format=\"XML\" NumberType=\"Float\" Precision=\"8\">0 -1.5</DataItem>",
+            "<DataItem Dimensions=\"2\" Format=\"XML\" NumberType=\"Float\" Precision=\"8\">0.1 0.5</DataItem>",
+            "</Geometry>"};
+
+        REQUIRE(r == xh::RegularGrid({3, 4}, {0.0, -1.5}, {0.1, 0.5}));
+
+        // independent of the global locale
+        struct comma : std::numpunct<char>
+        {
+            char do_decimal_point() const override
+            {
+                return ',';
+            }
+        };
+
+        std::locale previous = std::locale::global(std::locale(std::locale::classic(), new comma));
+        auto l = xh::RegularGrid({3, 4}, {0.0, -1.5}, {0.1, 0.5});
+        std::locale::global(previous);
+        REQUIRE(r == l);
+
+        H5Easy::File file("tmp.h5", H5Easy::File::Overwrite);
+
+        H5Easy::dump(file, "/y", std::vector<double>{0.0, 1.0, 3.0});
+        H5Easy::dump(file, "/x", std::vector<double>{0.0, 1.0, 2.0, 4.0});
+
+        std::vector<std::string> g = {
+            "<Topology Dimensions=\"3 4\" TopologyType=\"2DRectMesh\"/>",
+            "<Geometry GeometryType=\"VXVY\">",
+            "<DataItem Dimensions=\"4\" Format=\"HDF\" NumberType=\"Float\" Precision=\"8\">tmp.h5:/x</DataItem>",
+            "<DataItem Dimensions=\"3\" Format=\"HDF\" NumberType=\"Float\" Precision=\"8\">tmp.h5:/y</DataItem>",
+            "</Geometry>"};
+
+        REQUIRE(g == xh::RectilinearGrid(file, {"/y", "/x"}));
+    }
+
+    SECTION("SpatialCollection")
+    {
+        H5Easy::File file("tmp.h5", H5Easy::File::Overwrite);
+
+        GooseFEM::Mesh::Quad4::Regular mesh(3, 3);
+
+        H5Easy::dump(file, "/coor", mesh.coor());
+        H5Easy::dump(file, "/conn", mesh.conn());
+
+        auto partition = xh::Unstructured(file, "/coor", "/conn", mesh.getElementType());
+
+        xh::SpatialCollection collection;
+        std::vector<std::thread> threads;
+
+        for (size_t rank = 0; rank < 4; ++rank) {
+            threads.emplace_back([&collection, &partition, rank]() {
+                collection.insert(3 - rank, {partition});
+            });
+        }
+
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        REQUIRE(collection.size() == 4);
+
+        xh::SpatialCollection reference;
+
+        for (size_t rank = 0; rank < 4; ++rank) {
+            reference.insert(rank, {partition});
+        }
+
+        REQUIRE(collection.get() == reference.get());
+
+        std::map<size_t, xh::Element> partitions = {
+            {0, partition}, {2, xh::Element({"a", "", "b"})}, {3, xh::Element({"c\nd", "12\n", "\n"})}};
+        std::map<size_t, xh::Element> received;
+        xh::detail::deserialize(xh::detail::serialize(partitions), received);
+        REQUIRE(received.size() == 3);
+        REQUIRE(received[0].get() == partition.get());
+        REQUIRE(received[2].get() == std::vector<std::string>{"a", "", "b"});
+        REQUIRE(received[3].get() == std::vector<std::string>{"c\nd", "12\n", "\n"});
+
+        xh::TimeSeries series;
+        series.push_back(0.5, {xh::Increment(collection.get())});
+
+        auto lines = series.get();
+        REQUIRE(lines[1] == "<Grid CollectionType=\"Spatial\" GridType=\"Collection\" Name=\"Increment 0\">");
+        REQUIRE(lines[2] == "<Time Value=\"0.500000\"/>");
+        REQUIRE(lines[3] == "<Grid Name=\"SpatialCollection_0\">");
+
+        xh::TimeSeries nested;
+        nested.push_back(0.5, {collection.get()});
+
+        lines = nested.get();
+        REQUIRE(lines[1] == "<Grid Name=\"Increment 0\">");
+        REQUIRE(lines[3] == "<Grid CollectionType=\"Spatial\" GridType=\"Collection\" Name=\"SpatialCollection\">");
+        REQUIRE_THROWS(xh::Increment(partition));
+        REQUIRE_THROWS(series.push_back(1.0, {xh::Increment(collection.get()), partition}));
+    }
+
+    SECTION("VirtualDataSet")
+    {
+        std::vector<xh::Metadata> sources;
+
+        for (size_t rank = 0; rank < 2; ++rank) {
+            std::string fname = "tmp_" + std::to_string(rank) + ".h5";
+            H5Easy::File part(fname, H5Easy::File::Overwrite);
+            H5Easy::dump(part, "/coor", std::vector<double>(2 * (rank + 2), rank), {rank + 2, 2});
+            xh::MetadataCache cache(part);
+            sources.push_back(cache.get("/coor"));
+        }
+
+        H5Easy::File file("tmp.h5", H5Easy::File::Overwrite);
+        auto coor = xh::VirtualDataSet(file, "/coor", sources);
+
+        REQUIRE(coor.shape == std::vector<size_t>{5, 2});
+        REQUIRE(xh::Geometry(coor) == xh::Geometry(file, "/coor"));
+
+        std::vector<double> data;
+        file.getDataSet("/coor").read(data);
+        REQUIRE(data == std::vector<double>{0, 0, 0, 0, 1, 1, 1, 1, 1, 1});
+    }
+
+    SECTION("JOIN")
+    {
+        H5Easy::File file("tmp.h5", H5Easy::File::Overwrite);
+
+        H5Easy::dump(file, "/x", std::vector<double>(4));
+        H5Easy::dump(file, "/y", std::vector<double>(4));
+
+        std::vector<std::string> g = {
+            "<Geometry GeometryType=\"X_Y\">",
+            "<DataItem Dimensions=\"4\" Format=\"HDF\" NumberType=\"Float\" Precision=\"8\">tmp.h5:/x</DataItem>",
+            "<DataItem Dimensions=\"4\" Format=\"HDF\" NumberType=\"Float\" Precision=\"8\">tmp.h5:/y</DataItem>",
+            "</Geometry>"};
+
+        std::vector<std::string> a = {
+            "<Attribute AttributeType=\"Vector\" Center=\"Node\" Name=\"u\">",
+            "<DataItem Dimensions=\"4 2\" Function=\"JOIN($0, $1)\" ItemType=\"Function\">",
+            "<DataItem Dimensions=\"4\" Format=\"HDF\" NumberType=\"Float\" Precision=\"8\">tmp.h5:/x</DataItem>",
+            "<DataItem Dimensions=\"4\" Format=\"HDF\" NumberType=\"Float\" Precision=\"8\">tmp.h5:/y</DataItem>",
+            "</DataItem>",
+            "</Attribute>"};
+
+        xh::MetadataCache cache(file);
+
+        REQUIRE(g == xh::Geometry(file, {"/x", "/y"}));
+        REQUIRE(g == xh::Geometry(cache, {"/x", "/y"}));
+        REQUIRE(a == xh::Attribute(file, {"/x", "/y"}, xh::AttributeCenter::Node, "u"));
+        REQUIRE(a == xh::Attribute(cache, {"/x", "/y"}, xh::AttributeCenter::Node, "u"));
+    }
+
+    SECTION("Attribute - type")
+    {
+        std::vector<std::pair<std::vector<size_t>, std::string>> types = {
+            {{4}, "Scalar"},
+            {{4, 3}, "Vector"},
+            {{4, 6}, "Tensor6"},
+            {{4, 3, 3}, "Tensor"},
+            {{4, 2, 4}, "Matrix"}};
+
+        for (auto& item : types) {
+            auto a = xh::Attribute("tmp.h5", "/a", item.first, xh::AttributeCenter::Cell);
+            REQUIRE(a.attributes()[0].second == item.second);
+        }
+    }
+
+    SECTION("Subset")
+    {
+        H5Easy::File file("tmp.h5", H5Easy::File::Overwrite);
+
+        H5Easy::dump(file, "/crack", std::vector<size_t>{1, 4});
+
+        std::vector<std::string> subset = {
+            "<Grid GridType=\"Subset\" Name=\"crack\" Section=\"DataItem\">",
+            "<DataItem Dimensions=\"2\" Format=\"HDF\" NumberType=\"UInt\" Precision=\"8\">tmp.h5:/crack</DataItem>",
+            "<Grid Name=\"Target\" Reference=\"XML\">"
+            "/Xdmf/Domain//Grid[@Name='mesh' and not(@GridType='Collection')]</Grid>",
+            "</Grid>"};
+
+        REQUIRE(subset == xh::Subset(file, "/crack", "mesh", "crack"));
+
+        xh::TimeSeries series("crack");
+        series.push_back(0.5, {xh::Increment(xh::Subset(file, "/crack", "mesh", "crack"))});
+
+        auto lines = series.get();
+        REQUIRE(lines[1] == "<Grid GridType=\"Subset\" Name=\"Increment 0\" Section=\"DataItem\">");
+        REQUIRE(lines[2] == "<Time Value=\"0.500000\"/>");
+    }
+
+    SECTION("MixedTopology")
+    {
+        xt::xtensor<size_t, 2> tri({1, 3});
+        xt::xtensor<size_t, 2> quad({1, 4});
+        std::iota(tri.begin(), tri.end(), 0);
+        std::iota(quad.begin(), quad.end(), 1);
+
+        auto conn = xh::concatenate({
+            xh::mixed_connectivity(xh::ElementType::Triangle, tri),
+            xh::mixed_connectivity(xh::ElementType::Quadrilateral, quad)});
+
+        REQUIRE(conn == std::vector<size_t>{4, 0, 1, 2, 5, 1, 2, 3, 4});
+
+        H5Easy::File file("tmp.h5", H5Easy::File::Overwrite);
+        H5Easy::dump(file, "/conn", conn);
+
+        std::vector<std::string> t = {
+            "<Topology NumberOfElements=\"2\" TopologyType=\"Mixed\">",
+            "<DataItem Dimensions=\"9\" Format=\"HDF\" NumberType=\"UInt\" Precision=\"8\">tmp.h5:/conn</DataItem>",
+            "</Topology>"};
+
+        REQUIRE(t == xh::MixedTopology(file, "/conn", 2));
+    }
+
+    SECTION("element_type")
+    {
+        REQUIRE(xh::element_type("Quadrilateral") == xh::ElementType::Quadrilateral);
+        REQUIRE(xh::element_type("Hexahedron_20") == xh::ElementType::Hexahedron_20);
+        REQUIRE_THROWS(xh::element_type("Quad"));
+
+        // values of the original enumerators are unchanged
+        REQUIRE(static_cast<int>(xh::ElementType::Polyvertex) == 0);
+        REQUIRE(static_cast<int>(xh::ElementType::Triangle) == 1);
+        REQUIRE(static_cast<int>(xh::ElementType::Quadrilateral) == 2);
+        REQUIRE(static_cast<int>(xh::ElementType::Hexahedron) == 3);
+    }
+
+    SECTION("Runtime number of fields")
+    {
+        H5Easy::File file("tmp.h5", H5Easy::File::Overwrite);
+
+        GooseFEM::Mesh::Quad4::Regular mesh(3, 3);
+
+        H5Easy::dump(file, "/coor", mesh.coor());
+        H5Easy::dump(file, "/conn", mesh.conn());
+        H5Easy::dump(file, "/a", xt::xtensor<double, 1>::from_shape({16}));
+        H5Easy::dump(file, "/b", xt::xtensor<double, 1>::from_shape({16}));
+
+        auto expected = xh::Grid("mesh", {
+            xh::Unstructured(file, "/coor", "/conn", mesh.getElementType()),
+            xh::Attribute(file, "/a", xh::AttributeCenter::Node),
+            xh::Attribute(file, "/b", xh::AttributeCenter::Node)});
+
+        std::vector<xh::Element> fields;
+        fields.push_back(xh::Unstructured(file, "/coor", "/conn", mesh.getElementType()));
+        for (auto& name : {"/a", "/b"}) {
+            fields.push_back(xh::Attribute(file, name, xh::AttributeCenter::Node));
+        }
+
+        REQUIRE(expected == xh::Grid("mesh", fields.begin(), fields.end()));
+        REQUIRE(expected == xh::Grid("mesh", std::vector<xh::Element>(fields)));
+
+        xh::GridBuilder grid("mesh");
+        grid.add(xh::Unstructured(file, "/coor", "/conn", mesh.getElementType()));
+        grid.add(fields[1]).add(fields[2]);
+        REQUIRE(grid.size() == 3);
+        REQUIRE(expected == grid.get());
+
+        xh::TimeSeries a;
+        xh::TimeSeries b;
+        a.push_back(0.5, {fields[0], fields[1], fields[2]});
+        b.push_back(0.5, grid.release());
+        REQUIRE(grid.size() == 0);
+        REQUIRE(a.get() == b.get());
+
+        std::vector<std::vector<size_t>> parts = {{1, 2}, {}, {3}};
+        REQUIRE(xh::concatenate(std::move(parts)) == std::vector<size_t>{1, 2, 3});
+        auto& children = expected.children()[0].children();
+        REQUIRE(xh::concatenate(std::move(fields)) == xh::concatenate(children.begin(), children.end()));
+    }
+
+    SECTION("TimeSeries - compact storage")
+    {
+        xh::Element field = xh::Attribute("tmp.h5", "/disp/0", std::vector<size_t>{16, 2}, xh::AttributeCenter::Node, "disp");
+        xh::Element grid("Grid", {{"Name", "Increment 0"}});
+        grid.push_back(xh::Element("Time", {{"Value", "0.5"}}));
+        grid.push_back(xh::Element(std::vector<std::string>{"<!-- line -->"}));
+        grid.push_back(field);
+
+        xh::detail::string_pool pool;
+        std::vector<uint32_t> data;
+        xh::detail::encode(grid, pool, data);
+        xh::detail::encode(grid, pool, data);
+
+        size_t i = 0;
+        REQUIRE(grid == xh::detail::decode(data, i, pool));
+        REQUIRE(grid == xh::detail::decode(data, i, pool));
+        REQUIRE(i == data.size());
+        REQUIRE(pool[pool.intern("tmp.h5:")] == "tmp.h5:");
+
+        xh::TimeSeries series;
+        for (size_t inc = 0; inc < 3; ++inc) {
+            std::string path = "/disp/" + std::to_string(inc);
+            series.push_back(inc, {xh::Attribute("tmp.h5", path, std::vector<size_t>{16, 2}, xh::AttributeCenter::Node, "disp")});
+        }
+
+        xh::TimeSeries copy = series;
+        REQUIRE(copy.get() == series.get());
+        REQUIRE(series.get()[4] == "<DataItem Dimensions=\"16 2\" Format=\"HDF\">tmp.h5:/disp/0</DataItem>");
+    }
+
+    SECTION("ConcurrentTimeSeries")
+    {
+        H5Easy::File file("tmp.h5", H5Easy::File::Overwrite);
+
+        GooseFEM::Mesh::Quad4::Regular mesh(3, 3);
+
+        H5Easy::dump(file, "/coor", mesh.coor());
+        H5Easy::dump(file, "/conn", mesh.conn());
+
+        size_t n = 40;
+        auto shared = xh::Unstructured(file, "/coor", "/conn", mesh.getElementType());
+        auto field = [](size_t inc) {
+            return xh::Attribute("tmp.h5", "/disp/" + std::to_string(inc), std::vector<size_t>{16, 2}, xh::AttributeCenter::Node, "disp");
+        };
+
+        xh::TimeSeries expected;
+        expected.set_shared({shared});
+        for (size_t inc = 0; inc < n; ++inc) {
+            expected.push_back(0.5 * inc, {field(inc)});
+        }
+
+        xh::ConcurrentTimeSeries series("TimeSeries", 3);
+        series.set_shared({shared});
+
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < 4; ++t) {
+            threads.emplace_back([&series, &field, n, t]() {
+                for (size_t inc = n - 1 - t; inc < n; inc -= 4) {
+                    series.push_back(0.5 * inc, {field(inc)});
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        REQUIRE(series.size() == n);
+        REQUIRE(series.get() == expected.get());
+        REQUIRE(xh::write(series) == xh::write(expected));
+
+        // increments with the same time are written in the order in which they were added
+        xh::ConcurrentTimeSeries ties("TimeSeries", 3);
+        xh::TimeSeries ties_expected;
+        for (size_t inc = 0; inc < 6; ++inc) {
+            ties.push_back("inc" + std::to_string(5 - inc), 1.0, {field(inc)});
+            ties_expected.push_back("inc" + std::to_string(5 - inc), 1.0, {field(inc)});
+        }
+        REQUIRE(ties.get() == ties_expected.get());
+
+        // sorted by step index, not by time
+        xh::ConcurrentTimeSeries steps;
+        xh::TimeSeries steps_expected;
+        for (size_t inc = 0; inc < 4; ++inc) {
+            steps.insert(3 - inc, 0.5 * inc, {field(inc)});
+        }
+        for (size_t inc = 0; inc < 4; ++inc) {
+            steps_expected.push_back(0.5 * (3 - inc), {field(3 - inc)});
+        }
+        REQUIRE(steps.get() == steps_expected.get());
+
+        REQUIRE_THROWS(series.push_back(std::numeric_limits<double>::quiet_NaN(), {field(0)}));
+
+        // each thread has its own shard (slot)
+        std::vector<size_t> slots(4);
+        std::vector<std::thread> others;
+        for (size_t t = 0; t < slots.size(); ++t) {
+            others.emplace_back([&slots, t]() { slots[t] = xh::detail::thread_slot(); });
+        }
+        for (auto& thread : others) {
+            thread.join();
+        }
+        std::sort(slots.begin(), slots.end());
+        REQUIRE(std::unique(slots.begin(), slots.end()) == slots.end());
+        REQUIRE(xh::detail::thread_slot() == xh::detail::thread_slot());
+        REQUIRE(series.size() == n);
+    }
+
+    SECTION("AsyncWriter")
+    {
+        auto field = [](size_t inc) {
+            return xh::Attribute("tmp.h5", "/disp/" + std::to_string(inc), std::vector<size_t>{16, 2}, xh::AttributeCenter::Node, "disp");
+        };
+
+        xh::TimeSeries series;
+
+        {
+            xh::AsyncWriter writer(2);
+
+            for (size_t inc = 0; inc < 50; ++inc) {
+                series.push_back(inc, {field(inc)});
+                writer.write("tmp_async.xdmf", series);
+                writer.write("tmp_async_grid.xdmf", xh::Grid({field(inc)}));
+            }
+
+            writer.flush();
+            REQUIRE(writer.pending() == 0);
+
+            std::ifstream file("tmp_async.xdmf");
+            std::stringstream buffer;
+            buffer << file.rdbuf();
+            REQUIRE(buffer.str() == xh::write(series) + "\n");
+            REQUIRE(!std::ifstream("tmp_async.xdmf.tmp").good());
+
+            writer.write("non-existing-directory/tmp.xdmf", series);
+            REQUIRE_THROWS(writer.flush());
+        }
+
+        std::ifstream file("tmp_async_grid.xdmf");
+        std::stringstream buffer;
+        buffer << file.rdbuf();
+        REQUIRE(buffer.str() == xh::write(xh::Grid({field(49)})) + "\n");
+    }
+
+    SECTION("AsyncWriter - coalescing and back-pressure")
+    {
+        auto field = [](size_t inc) {
+            return xh::Attribute("tmp.h5", "/disp/" + std::to_string(inc), std::vector<size_t>{16, 2}, xh::AttributeCenter::Node, "disp");
+        };
+
+        auto read = [](const std::string& fname) {
+            std::ifstream file(fname);
+            std::stringstream buffer;
+            buffer << file.rdbuf();
+            return buffer.str();
+        };
+
+        std::promise<void> release;
+        xh::detail::blocking block{release.get_future().share(), std::make_shared<std::atomic<bool>>(false)};
+
+        xh::TimeSeries series;
+        series.set_shared({field(0)});
+        series.push_back(0, {field(1)});
 
+        xh::AsyncWriter writer(2);
+        writer.write("tmp_async_block.xdmf", block);
+
+        while (!*block.started) {
+            std::this_thread::yield();
+        }
+
+        // the queue is full after two requests, further requests for the same files are coalesced
+        writer.write("tmp_async.xdmf", series);
+        writer.write("tmp_async_grid.xdmf", xh::Grid({field(0)}));
+
+        for (size_t inc = 2; inc < 10; ++inc) {
+            series.push_back(inc, {field(inc)});
+            writer.write("tmp_async.xdmf", series);
+            writer.write("tmp_async_grid.xdmf", xh::Grid({field(inc)}));
+        }
+
+        REQUIRE(writer.pending() == 3);
+
+        // a request for another file waits for room in the queue
+        std::atomic<bool> written(false);
+        std::thread other([&]() {
+            writer.write("tmp_async_other.xdmf", xh::Grid({field(0)}));
+            written = true;
+        });
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        REQUIRE(!written);
+        REQUIRE(writer.pending() == 3);
+
+        release.set_value();
+        other.join();
+        writer.flush();
+
+        REQUIRE(written);
+        REQUIRE(read("tmp_async.xdmf") == xh::write(series) + "\n");
+        REQUIRE(read("tmp_async_grid.xdmf") == xh::write(xh::Grid({field(9)})) + "\n");
+        REQUIRE(read("tmp_async_other.xdmf") == xh::write(xh::Grid({field(0)})) + "\n");
+
+        // only the new increments are passed to the background thread
+        series.push_back(10, {field(10)});
+        writer.write("tmp_async.xdmf", series);
+        writer.flush();
+        REQUIRE(read("tmp_async.xdmf") == xh::write(series) + "\n");
+
+        // another TimeSeries written to the same file is copied completely
+        xh::TimeSeries restart;
+        restart.push_back(0, {field(0)});
+        writer.write("tmp_async.xdmf", restart);
+        writer.write("tmp_async.xdmf", xh::Grid({field(0)}));
+        writer.write("tmp_async.xdmf", restart);
+        writer.flush();
+        REQUIRE(read("tmp_async.xdmf") == xh::write(restart) + "\n");
+
+        // a TimeSeries that is assigned to (in place) is copied completely,
+        // also if it has more increments than when it was written before
+        writer.write("tmp_async.xdmf", series);
+        writer.flush();
+        series = xh::TimeSeries();
+        for (size_t inc = 0; inc < 20; ++inc) {
+            series.push_back(inc, {field(100 + inc)});
+        }
+        writer.write("tmp_async.xdmf", series);
+        writer.flush();
+        REQUIRE(read("tmp_async.xdmf") == xh::write(series) + "\n");
+    }
+
+    SECTION("Discover")
+    {
+        H5Easy::File file("tmp.h5", H5Easy::File::Overwrite);
+
+        GooseFEM::Mesh::Quad4::Regular mesh(3, 3);
+
+        H5Easy::dump(file, "/coor", mesh.coor());
+        H5Easy::dump(file, "/conn", mesh.conn());
+        H5Easy::dump(file, "/time", std::vector<double>{0.0, 0.5, 1.0});
+        H5Easy::dump(file, "/other/1", std::vector<double>(5));
+
+        for (size_t inc = 0; inc < 3; ++inc) {
+            H5Easy::dump(file, "/disp/" + std::to_string(inc), xt::xtensor<double, 2>::from_shape({16, 2}));
+            H5Easy::dump(file, "/stress/" + std::to_string(inc), xt::xtensor<double, 1>::from_shape({9}));
+        }
+
+        xh::TimeSeries expected;
+        expected.set_shared({xh::Unstructured(file, "/coor", "/conn", mesh.getElementType())});
+        for (size_t inc = 0; inc < 3; ++inc) {
+            expected.push_back(0.5 * inc, {
+                xh::Attribute(file, "/disp/" + std::to_string(inc), xh::AttributeCenter::Node, "disp"),
+                xh::Attribute(file, "/stress/" + std::to_string(inc), xh::AttributeCenter::Cell, "stress")});
+        }
+
+        auto series = xh::Discover(file, "/coor", "/conn", mesh.getElementType(), "/(\\w+)/(\\d+)", "/time");
+        REQUIRE(series.get() == expected.get());
+
+        xh::MetadataCache prefetched(file);
+        prefetched.prefetch();
+        prefetched.invalidate("/time");
+        series = xh::Discover(prefetched, "/coor", "/conn", mesh.getElementType(), "/(\\w+)/(\\d+)", std::vector<double>{0.0, 0.5, 1.0});
+        REQUIRE(series.get() == expected.get());
+
+        // the increment has to be an unsigned integer
+        H5Easy::dump(file, "/disp/last", xt::xtensor<double, 2>::from_shape({16, 2}));
+        REQUIRE_THROWS_AS(
+            xh::Discover(file, "/coor", "/conn", mesh.getElementType(), "/(\\w+)/(\\w+)"),
+            std::runtime_error);
+
+        // equal number of nodes and elements: the center has to be specified
+        H5Easy::dump(file, "/mesh/coor", xt::xtensor<double, 2>::from_shape({9, 2}));
+        REQUIRE_THROWS(xh::Discover(file, "/mesh/coor", "/conn", mesh.getElementType()));
+
+        xh::TimeSeries cells;
+        cells.set_shared({xh::Unstructured(file, "/mesh/coor", "/conn", mesh.getElementType())});
+        for (size_t inc = 0; inc < 3; ++inc) {
+            cells.push_back("Increment " + std::to_string(inc), inc, {
+                xh::Attribute(file, "/stress/" + std::to_string(inc), xh::AttributeCenter::Cell, "stress")});
+        }
+
+        series = xh::Discover(
+            file, "/mesh/coor", "/conn", mesh.getElementType(), "/(\\w+)/(\\d+)", "",
+            {{"stress", xh::AttributeCenter::Cell}});
+        REQUIRE(series.get() == cells.get());
+
+        xh::MetadataCache cache(file, "relative.h5");
+        REQUIRE(cache.get("/coor").filename == "relative.h5");
+    }
+
+    SECTION("Resume")
+    {
+        H5Easy::File file("tmp.h5", H5Easy::File::Overwrite);
+
+        GooseFEM::Mesh::Quad4::Regular mesh(3, 3);
+
+        H5Easy::dump(file, "/coor", mesh.coor());
+        H5Easy::dump(file, "/conn", mesh.conn());
+
+        for (size_t inc = 0; inc < 2; ++inc) {
+            H5Easy::dump(file, "/disp/" + std::to_string(inc), xt::xtensor<double, 2>::from_shape({16, 2}));
+        }
+
+        auto field = [](size_t inc) {
+            return xh::Attribute("tmp.h5", "/disp/" + std::to_string(inc), std::vector<size_t>{16, 2}, xh::AttributeCenter::Node, "disp");
+        };
+
+        xh::TimeSeries series("Series");
+        series.set_shared({xh::Unstructured(file, "/coor", "/conn", mesh.getElementType())});
+        for (size_t inc = 0; inc < 3; ++inc) {
+            series.push_back(0.5 * inc, {field(inc)});
+        }
+
+        xh::write("tmp_resume.xdmf", series);
+
+        xh::TimeSeries resumed = xh::Resume("tmp_resume.xdmf");
+        REQUIRE(resumed.get() == series.get());
+
+        series.push_back(1.5, {field(3)});
+        resumed.push_back(1.5, {field(3)});
+        REQUIRE(resumed.get() == series.get());
+
+        // "/disp/2" was not written: only the first two increments are resumed
+        xh::TimeSeries truncated = xh::Resume("tmp_resume.xdmf", file);
+        truncated.push_back(1.0, {field(2)});
+
+        xh::TimeSeries expected("Series");
+        expected.set_shared({xh::Unstructured(file, "/coor", "/conn", mesh.getElementType())});
+        for (size_t inc = 0; inc < 3; ++inc) {
+            expected.push_back(0.5 * inc, {field(inc)});
+        }
+
+        REQUIRE(truncated.get() == expected.get());
+
+        // one increment: without reference to them, no fields are taken to be shared
+        xh::TimeSeries single("Series");
+        single.push_back(0.0, {xh::Unstructured(file, "/coor", "/conn", mesh.getElementType()), field(0)});
+        xh::write("tmp_resume.xdmf", single);
+
+        xh::TimeSeries resumed_single = xh::Resume("tmp_resume.xdmf");
+        REQUIRE(resumed_single.get() == single.get());
+        resumed_single.push_back(0.5, {xh::Unstructured(file, "/coor", "/conn", mesh.getElementType()), field(1)});
+        single.push_back(0.5, {xh::Unstructured(file, "/coor", "/conn", mesh.getElementType()), field(1)});
+        REQUIRE(resumed_single.get() == single.get());
+
+        // one increment, truncated from a file with a reference: the shared fields are resumed
+        xh::TimeSeries shared("Series");
+        shared.set_shared({xh::Unstructured(file, "/coor", "/conn", mesh.getElementType())});
+        shared.push_back(0.0, {field(0)});
+        shared.push_back(0.5, {field(3)});
+        xh::write("tmp_resume.xdmf", shared);
+
+        xh::TimeSeries resumed_shared = xh::Resume("tmp_resume.xdmf", file);
+        resumed_shared.push_back(0.5, {field(1)});
+
+        xh::TimeSeries expected_shared("Series");
+        expected_shared.set_shared({xh::Unstructured(file, "/coor", "/conn", mesh.getElementType())});
+        expected_shared.push_back(0.0, {field(0)});
+        expected_shared.push_back(0.5, {field(1)});
+        REQUIRE(resumed_shared.get() == expected_shared.get());
+
+        // the XDMF-file refers to the HDF5-file by a different (relative) name
+        xh::TimeSeries relative;
+        for (size_t inc = 0; inc < 3; ++inc) {
+            relative.push_back(inc, {xh::Attribute("./tmp.h5", "/disp/" + std::to_string(inc), std::vector<size_t>{16, 2}, xh::AttributeCenter::Node, "disp")});
+        }
+        xh::write("tmp_resume.xdmf", relative);
+
+        xh::TimeSeries relative_expected;
+        for (size_t inc = 0; inc < 2; ++inc) {
+            relative_expected.push_back(inc, {xh::Attribute("./tmp.h5", "/disp/" + std::to_string(inc), std::vector<size_t>{16, 2}, xh::AttributeCenter::Node, "disp")});
+        }
+
+        REQUIRE(xh::Resume("tmp_resume.xdmf").get() == relative.get());
+        REQUIRE(xh::Resume("tmp_resume.xdmf", file).get() == relative_expected.get());
+    }
+}
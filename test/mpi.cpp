@@ -0,0 +1,57 @@
+#define CATCH_CONFIG_RUNNER
+#include <catch2/catch.hpp>
+#include <mpi.h>
+
+#define XDMFWRITE_HIGHFIVE_INDENT 0
+#define XDMFWRITE_HIGHFIVE_USE_MPI
+#include <XDMFWrite_HighFive.hpp>
+
+namespace xh = XDMFWrite_HighFive;
+
+int main(int argc, char* argv[])
+{
+    MPI_Init(&argc, &argv);
+    int ret = Catch::Session().run(argc, argv);
+    MPI_Finalize();
+    return ret;
+}
+
+TEST_CASE("XDMFWrite_HighFive::mpi", "XDMFWrite_HighFive.hpp")
+{
+    SECTION("SpatialCollection::gather")
+    {
+        int rank;
+        int size;
+        MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+        MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+        auto geometry = [](size_t r) {
+            std::string fname = "tmp_" + std::to_string(r) + ".h5";
+            return xh::Geometry(fname, "/coor", std::vector<size_t>{4 + r, 2});
+        };
+
+        auto topology = [](size_t r) {
+            std::string fname = "tmp_" + std::to_string(r) + ".h5";
+            return xh::Topology(fname, "/conn", {1 + r, 4}, xh::ElementType::Quadrilateral);
+        };
+
+        // text containing a newline is sent unchanged
+        auto information = [](size_t r) {
+            return xh::Element("Information", {{"Name", "rank"}}, "rank\n" + std::to_string(r));
+        };
+
+        size_t r = static_cast<size_t>(rank);
+        xh::SpatialCollection collection;
+        collection.insert(r, {geometry(r), topology(r), information(r)});
+        collection.gather(MPI_COMM_WORLD, 0);
+
+        if (rank == 0) {
+            xh::SpatialCollection expected;
+            for (size_t i = 0; i < static_cast<size_t>(size); ++i) {
+                expected.insert(i, {geometry(i), topology(i), information(i)});
+            }
+            REQUIRE(collection.size() == static_cast<size_t>(size));
+            REQUIRE(collection.get() == expected.get());
+        }
+    }
+}